@@ -0,0 +1,73 @@
+/*
+  BankSlice.cpp
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+*/
+
+#include "BankSlice.h"
+#include <cassert>
+#include "StringBank.h"
+
+void BankSlice::Attach(StringBank *owner, int offset) {
+  owner_ = owner;
+  offset_ = offset;
+}
+
+DampedOscillatorBank *BankSlice::bank() { return owner_->bank(); }
+
+bool BankSlice::Init(int capacity, tMempool *pool, int num_outputs) {
+  if (owner_ == nullptr) {
+    return false;
+  }
+  assert(offset_ + capacity <= bank()->capacity());
+  assert(num_outputs < bank()->num_outputs());
+  capacity_ = capacity;
+  num_outputs_ = num_outputs;
+  return true;
+}
+
+void BankSlice::Reset() {
+  bank()->Reset(offset_, offset_ + capacity_);
+}
+
+void BankSlice::set_freq(int i, float freq) {
+  bank()->set_freq(offset_ + i, freq);
+}
+
+void BankSlice::set_decay(int i, float decay) {
+  bank()->set_decay(offset_ + i, decay);
+}
+
+BankSlice::Mode BankSlice::mode(int i) const {
+  return owner_->bank()->mode(offset_ + i);
+}
+
+void BankSlice::set_mode(int i, const Mode &mode) {
+  bank()->set_mode(offset_ + i, mode);
+}
+
+void BankSlice::set_freq_and_decay(int i, float freq, float decay) {
+  bank()->set_freq_and_decay(offset_ + i, freq, decay);
+}
+
+void BankSlice::set_gain(int k, int i, float gain) {
+  bank()->set_gain(k, offset_ + i, gain);
+}
+
+void BankSlice::set_num_active(int num_active) {
+  for (int i = num_active; i < capacity_; ++i) {
+    for (int k = 0; k < num_outputs_; ++k) {
+      bank()->set_gain(k, offset_ + i, 0.0f);
+    }
+  }
+  owner_->SetCouplingGains(offset_, capacity_, num_active);
+}
+
+void BankSlice::Publish() { bank()->Publish(); }
+
+void BankSlice::set_sample_rate(float sr) { bank()->set_sample_rate(sr); }
+
+void BankSlice::set_ramp_length(int num_samples) {
+  bank()->set_ramp_length(num_samples);
+}
@@ -0,0 +1,73 @@
+/*
+  BankSlice.h
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+
+  The oscillator policy of the strings of a StringBank: a contiguous range
+  of the oscillators of the DampedOscillatorBank that the StringBank shares
+  among its strings.  The setters pass through to that range, and Reset()
+  restarts only that range.  The StringBank renders the whole shared bank
+  at once, so Process() does nothing, and it owns the shared bank's
+  storage, so a slice needs none.  See StringBank.h.
+
+  Besides the string's pickups, each oscillator has a gain in the bridge
+  output of the shared bank and an input gain, which set_num_active() asks
+  the StringBank to fill in (and clears above num_active, along with the
+  pickup gains, since the shared bank renders every oscillator).
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include "DampedOscillatorBank.h"
+
+class StringBank;
+
+class BankSlice {
+ public:
+  // one output of the shared bank is the bridge
+  static const int kMaxOutputs = DampedOscillatorBank::kMaxOutputs - 1;
+
+  // Use oscillators offset <= i < offset + capacity of owner's bank.  Must
+  // be called before Init().
+  void Attach(StringBank *owner, int offset);
+
+  // As for DampedOscillatorBank, but allocating nothing.  capacity and
+  // num_outputs must fit the owner's bank.
+  bool Init(int capacity, tMempool *pool, int num_outputs = 1);
+  int capacity() const { return capacity_; }
+  static constexpr size_t StorageBytes(int capacity, int num_outputs = 1) {
+    return 0;
+  }
+
+  // Rendering side
+  void Process(float *const *out, size_t size) {}
+  void Process(const float *in, float *const *out, size_t size) {}
+  void Reset();
+
+  // Coefficient side, as for DampedOscillatorBank
+  void set_freq(int i, float freq);
+  void set_decay(int i, float decay);
+  void set_freq_and_decay(int i, float freq, float decay);
+  void set_gain(int k, int i, float gain);
+  void set_gain(int i, float gain) { set_gain(0, i, gain); }
+  // The shared bank's input is the bridge, so this does nothing
+  void set_input_gain(int i, float gain) {}
+  void set_num_active(int num_active);
+  typedef DampedOscillatorBank::Mode Mode;
+  Mode mode(int i) const;
+  void set_mode(int i, const Mode &mode);
+  void Publish();
+  // These apply to the whole shared bank
+  void set_sample_rate(float sr);
+  void set_ramp_length(int num_samples);
+
+ private:
+  DampedOscillatorBank *bank();
+
+  StringBank *owner_ = nullptr;
+  int offset_ = 0;
+  int capacity_ = 0;
+  int num_outputs_ = 0;
+};
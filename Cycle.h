@@ -3,47 +3,150 @@
   Clancy Rowley
 
   Copyright 2023 Clarence W. Rowley
+
+  Wavetable sine oscillator driven by a 32-bit phasor.  The table has
+  2^kTableBits entries and is generated at compile time, to full float
+  precision, so each instantiation only costs the table memory it asks for.
+  kOrder selects the interpolation between table entries: 0 (none),
+  1 (linear) or 3 (cubic Hermite).  The peak error is about
+  3 * 2^-kTableBits for order 0, 5 * 4^-kTableBits for order 1 and
+  4 * 8^-kTableBits for order 3, so a 256-entry cubic table is more
+  accurate than a 2048-entry linear one.
+
+  Cycle is the 2048-entry, linearly interpolated oscillator.
 */
 
 #pragma once
 
-#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
 
 const int SINE_TABLE_BITS = 11;  // 2048-long table
 
-extern const float __sine_table[1 << SINE_TABLE_BITS];
+// Table of sin(2 pi k / 2^kBits), with one guard point before k = 0 and two
+// after k = 2^kBits - 1, so interpolation never needs to wrap the index.
+template <int kBits>
+struct SineTable {
+  static const int kSize = 1 << kBits;
+
+  constexpr SineTable() : data() {
+    // Evaluate the first quarter wave, and fill in the rest by symmetry
+    for (int k = 0; k <= kSize / 4; ++k) {
+      data[k + 1] = static_cast<float>(QuarterSin(k, kSize));
+    }
+    for (int k = kSize / 4 + 1; k <= kSize / 2; ++k) {
+      data[k + 1] = data[kSize / 2 - k + 1];
+    }
+    for (int k = kSize / 2 + 1; k <= kSize + 1; ++k) {
+      data[k + 1] = -data[k - kSize / 2 + 1];
+    }
+    data[0] = -data[2];
+  }
+
+  // Return sin(2 pi k / n) for 0 <= k <= n/4, evaluated in double precision
+  // by its Taylor series, which converges fully in 14 terms.
+  static constexpr double QuarterSin(int k, int n) {
+    const double kPi = 3.14159265358979323846;
+    const double x = 2 * kPi * k / n;
+    const double x_sq = x * x;
+    double sum = 1.0;
+    for (int i = 13; i > 0; --i) {
+      sum = 1.0 - sum * x_sq / ((2 * i) * (2 * i + 1));
+    }
+    return x * sum;
+  }
+
+  float data[kSize + 3];
+};
+
+template <int kTableBits, int kOrder>
+class BasicCycle {
+  static_assert(kTableBits >= 2 && kTableBits <= 16, "unsupported table size");
+  static_assert(kOrder == 0 || kOrder == 1 || kOrder == 3,
+                "interpolation order must be 0, 1 or 3");
 
-class Cycle {
  public:
-  Cycle() {}
-  explicit Cycle(float sample_rate);
-  ~Cycle();
+  BasicCycle() {}
+  explicit BasicCycle(float sample_rate)
+      : phase_(0), inc_(0), freq_(0.0f) {
+    set_sample_rate(sample_rate);
+  }
 
   inline float Tick() {
     // Phasor increment
     phase_ += inc_;
-    // Wavetable synthesis
-    const char frac_bits = 32 - SINE_TABLE_BITS;
-    const uint32_t frac_mask = (1 << frac_bits) - 1;
-    uint32_t idx = phase_ >> frac_bits;
-    uint32_t frac = phase_ & frac_mask;
-    const float one_over_delta_sample = 1.0f / (1 << frac_bits);
-    float delta = static_cast<float>(frac * one_over_delta_sample);
+    return Lookup(phase_);
+  }
 
-    const uint32_t table_mask = (1 << SINE_TABLE_BITS) - 1;
-    float samp0 = __sine_table[idx];
-    idx = (idx + 1) & table_mask;
-    float samp1 = __sine_table[idx];
+  // Fill out with the next size samples.  The phases of a block are
+  // computed independently of one another (not by accumulating the
+  // increment), so the compiler can work out several of them per
+  // instruction; only the table reads themselves are serial.
+  void Process(float *out, size_t size) {
+    const int kChunk = 16;
+    uint32_t idx[kChunk];
+    float delta[kChunk];
+    while (size > 0) {
+      const size_t n = size < kChunk ? size : kChunk;
+      // Always a full chunk, so this loop is branch-free and vectorizes
+      for (int j = 0; j < kChunk; ++j) {
+        const uint32_t phase = phase_ + (j + 1) * static_cast<uint32_t>(inc_);
+        idx[j] = phase >> kFracBits;
+        delta[j] = (phase & kFracMask) * kOneOverDelta;
+      }
+      for (size_t j = 0; j < n; ++j) {
+        out[j] = Interpolate(idx[j], delta[j]);
+      }
+      phase_ += n * static_cast<uint32_t>(inc_);
+      out += n;
+      size -= n;
+    }
+  }
 
-    return samp0 + (samp1 - samp0) * delta;
+  // Interpolated sine of a phase, where 2^32 is a full cycle
+  static inline float Lookup(uint32_t phase) {
+    return Interpolate(phase >> kFracBits, (phase & kFracMask) * kOneOverDelta);
   }
 
   // change parameters
-  void set_freq(float freq);
-  void set_phase(float phase);
-  void set_sample_rate(float sr);
+  void set_freq(float freq_hz) {
+    freq_ = freq_hz;
+    inc_ = freq_hz * inv_sample_rate_times_two_to_32_;
+  }
+  void set_phase(float phase) {
+    phase -= static_cast<int>(phase);
+    phase_ = phase * kTwoTo32;
+  }
+  void set_sample_rate(float sr) {
+    sample_rate_ = sr;
+    inv_sample_rate_times_two_to_32_ = kTwoTo32 / sr;
+  }
 
  private:
+  static constexpr int kFracBits = 32 - kTableBits;
+  static constexpr uint32_t kFracMask = (1u << kFracBits) - 1;
+  static constexpr float kOneOverDelta = 1.0f / (1u << kFracBits);
+  static constexpr float kTwoTo32 = 4294967296.0f;
+
+  // Interpolate table entries idx, idx + 1 at fraction 0 <= delta < 1
+  static inline float Interpolate(uint32_t idx, float delta) {
+    // table_.data[idx + 1] is entry idx, because of the leading guard point
+    const float *p = table_.data + idx + 1;
+    if (kOrder == 0) {
+      return p[0];
+    } else if (kOrder == 1) {
+      return p[0] + (p[1] - p[0]) * delta;
+    } else {
+      // Catmull-Rom spline through p[-1], p[0], p[1], p[2]
+      const float c1 = 0.5f * (p[1] - p[-1]);
+      const float c2 = p[-1] - 2.5f * p[0] + 2.0f * p[1] - 0.5f * p[2];
+      const float c3 = 0.5f * (p[2] - p[-1]) + 1.5f * (p[0] - p[1]);
+      return ((c3 * delta + c2) * delta + c1) * delta + p[0];
+    }
+  }
+
+  static constexpr SineTable<kTableBits> table_ = SineTable<kTableBits>();
+
   // Underlying phasor
   uint32_t phase_;
   int32_t inc_;
@@ -51,3 +154,8 @@ class Cycle {
   float sample_rate_;
   float inv_sample_rate_times_two_to_32_;
 };
+
+template <int kTableBits, int kOrder>
+constexpr SineTable<kTableBits> BasicCycle<kTableBits, kOrder>::table_;
+
+typedef BasicCycle<SINE_TABLE_BITS, 1> Cycle;
@@ -0,0 +1,220 @@
+/*
+  CycleBank.cpp
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+*/
+
+#include "CycleBank.h"
+#include <math.h>
+#include <cassert>
+#include "FastMath.h"
+#include "Simd.h"
+#include "leaflet.h"  // also defines TWO_PI and TWO_TO_32
+
+#if defined(__GNUC__)
+#define UNROLL _Pragma("GCC unroll 8")
+#else
+#define UNROLL
+#endif
+
+CycleBank::CycleBank(float sample_rate)
+    : capacity_(0), num_outputs_(0), max_outputs_(0), pool_(nullptr),
+      storage_(nullptr) {
+  set_sample_rate(sample_rate);
+}
+
+CycleBank::~CycleBank() {
+  if (storage_ != nullptr) {
+    mpool_free(storage_, pool_);
+  }
+}
+
+bool CycleBank::Init(int capacity, tMempool *pool, int num_outputs) {
+  assert(num_outputs > 0 && num_outputs <= kMaxOutputs);
+  num_outputs_ = num_outputs;
+  if (capacity > capacity_ || num_outputs > max_outputs_) {
+    if (storage_ != nullptr) {
+      mpool_free(storage_, pool_);
+    }
+    capacity_ = 0;
+    max_outputs_ = 0;
+    pool_ = pool;
+    storage_ = static_cast<char *>(
+        mpool_alloc(StorageBytes(capacity, num_outputs), pool));
+    if (storage_ == nullptr) {
+      num_outputs_ = 0;
+      return false;
+    }
+    // all the arrays have 4-byte elements
+    const int stride = simd_padded(capacity);
+    uint32_t *p = reinterpret_cast<uint32_t *>(simd_align(storage_));
+    phase_ = p;
+    envelope_ = reinterpret_cast<float *>(p + stride);
+    p += 2 * stride;
+    for (Coefficients &c : slots_) {
+      c.inc = p;
+      c.decay = reinterpret_cast<float *>(p + stride);
+      p += 2 * stride;
+      for (int k = 0; k < num_outputs; ++k) {
+        c.gain[k] = reinterpret_cast<float *>(p);
+        p += stride;
+      }
+    }
+    capacity_ = capacity;
+    max_outputs_ = num_outputs;
+  }
+  for (int i = 0; i < capacity_; ++i) {
+    phase_[i] = 0;
+    envelope_[i] = 0.0f;
+  }
+  for (Coefficients &c : slots_) {
+    for (int i = 0; i < capacity_; ++i) {
+      c.inc[i] = 0;
+      c.decay[i] = 1.0f;
+      for (int k = 0; k < num_outputs_; ++k) {
+        c.gain[k][i] = 0.0f;
+      }
+    }
+    c.num_active = 0;
+  }
+  buffer_.Reset();
+  return true;
+}
+
+void CycleBank::set_sample_rate(float sr) {
+  two_pi_by_sample_rate_ = TWO_PI / sr;
+  inv_sample_rate_times_two_to_32_ = TWO_TO_32 / sr;
+}
+
+void CycleBank::set_freq(int i, float freq_hz) {
+  slots_[buffer_.back()].inc[i] =
+      static_cast<int32_t>(freq_hz * inv_sample_rate_times_two_to_32_);
+}
+
+// The decay is the (time-varying) decay rate sigma of the envelope
+// exp(-2 pi sigma t), as for DampedOscillatorBank.
+void CycleBank::set_decay(int i, float decay) {
+  slots_[buffer_.back()].decay[i] = expf(-decay * two_pi_by_sample_rate_);
+}
+
+void CycleBank::set_freq_and_decay(int i, float freq_hz, float decay) {
+  set_freq(i, freq_hz);
+  slots_[buffer_.back()].decay[i] =
+      fast_expf(-decay * two_pi_by_sample_rate_);
+}
+
+void CycleBank::set_gain(int k, int i, float gain) {
+  slots_[buffer_.back()].gain[k][i] = gain;
+}
+
+void CycleBank::set_num_active(int num_active) {
+  slots_[buffer_.back()].num_active = num_active;
+}
+
+CycleBank::Mode CycleBank::mode(int i) const {
+  const Coefficients &back = slots_[buffer_.back()];
+  return {back.inc[i], back.decay[i]};
+}
+
+void CycleBank::set_mode(int i, const Mode &mode) {
+  Coefficients &back = slots_[buffer_.back()];
+  back.inc[i] = mode.inc;
+  back.decay[i] = mode.decay;
+}
+
+void CycleBank::Publish() {
+  const Coefficients &published = slots_[buffer_.Publish()];
+  Coefficients &back = slots_[buffer_.back()];
+  for (int i = 0; i < capacity_; ++i) {
+    back.inc[i] = published.inc[i];
+    back.decay[i] = published.decay[i];
+    for (int k = 0; k < num_outputs_; ++k) {
+      back.gain[k][i] = published.gain[k][i];
+    }
+  }
+  back.num_active = published.num_active;
+}
+
+void CycleBank::Reset() {
+  buffer_.Acquire();
+  for (int i = 0; i < capacity_; ++i) {
+    phase_[i] = 0;
+    envelope_[i] = 1.0f;
+  }
+}
+
+// Advance K oscillators, starting at index i, by size samples, adding their
+// weighted outputs to out[o] for each of kOutputs outputs.  The envelope
+// update is a serial multiply, so interleaving several oscillators keeps
+// the pipeline busy.
+template <int K, int kOutputs>
+inline void CycleBank::ProcessOscillators(float *const *out, size_t size,
+                                          int i, const Coefficients &c) {
+  float gain[kOutputs][K], decay[K], envelope[K];
+  uint32_t inc[K], phase[K];
+  UNROLL
+  for (int k = 0; k < K; ++k) {
+    UNROLL
+    for (int o = 0; o < kOutputs; ++o) {
+      gain[o][k] = c.gain[o][i + k];
+    }
+    decay[k] = c.decay[i + k];
+    envelope[k] = envelope_[i + k];
+    inc[k] = c.inc[i + k];
+    phase[k] = phase_[i + k];
+  }
+  for (size_t j = 0; j < size; ++j) {
+    float sum[kOutputs];
+    UNROLL
+    for (int o = 0; o < kOutputs; ++o) {
+      sum[o] = out[o][j];
+    }
+    UNROLL
+    for (int k = 0; k < K; ++k) {
+      phase[k] += inc[k];
+      envelope[k] *= decay[k];
+      float value = envelope[k] * Cycle::Lookup(phase[k]);
+      UNROLL
+      for (int o = 0; o < kOutputs; ++o) {
+        sum[o] += gain[o][k] * value;
+      }
+    }
+    UNROLL
+    for (int o = 0; o < kOutputs; ++o) {
+      out[o][j] = sum[o];
+    }
+  }
+  UNROLL
+  for (int k = 0; k < K; ++k) {
+    phase_[i + k] = phase[k];
+    envelope_[i + k] = envelope[k];
+  }
+}
+
+// Phase and envelope are continuous across coefficient changes, so new
+// coefficients are simply used from the next block on.
+template <int kOutputs>
+void CycleBank::Render(float *const *out, size_t size) {
+  buffer_.Acquire();
+  const Coefficients &c = slots_[buffer_.front()];
+  const int K = 4;  // oscillators processed together
+  int i = 0;
+  for (; i + K <= c.num_active; i += K) {
+    ProcessOscillators<K, kOutputs>(out, size, i, c);
+  }
+  for (; i < c.num_active; ++i) {
+    ProcessOscillators<1, kOutputs>(out, size, i, c);
+  }
+}
+
+void CycleBank::Process(float *const *out, size_t size) {
+  static_assert(kMaxOutputs == 4, "one case per number of outputs");
+  switch (num_outputs_) {
+    case 1: Render<1>(out, size); break;
+    case 2: Render<2>(out, size); break;
+    case 3: Render<3>(out, size); break;
+    case 4: Render<4>(out, size); break;
+    default: break;
+  }
+}
@@ -0,0 +1,109 @@
+/*
+  CycleBank.h
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+
+  A bank of exponentially decaying sine oscillators, each a wavetable
+  phasor (see Cycle.h) times an envelope that is scaled by a constant
+  factor every sample.  It has the same interface as DampedOscillatorBank,
+  and after Reset() it produces very nearly the same signal, r^n sin(n w),
+  so the two are interchangeable as the oscillator policy of BasicStiffString.
+  As there, the setters fill a back buffer of coefficients, which Publish()
+  hands to the rendering side.
+
+  Which is faster depends on the target: this bank has no serial two-state
+  recurrence, but needs two table reads per oscillator and sample.
+  Frequency and decay changes are continuous in phase and amplitude here,
+  so there is nothing to smooth, and set_ramp_length() has no effect.
+  A phasor cannot be driven by a signal, so the input of Process() is
+  ignored.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "Cycle.h"
+#include "Simd.h"
+#include "TripleBuffer.h"
+
+struct tMempool;  // leaflet.h
+
+class CycleBank {
+ public:
+  CycleBank() : CycleBank(1.0f) {}
+  explicit CycleBank(float sample_rate);
+  ~CycleBank();
+  CycleBank(const CycleBank &) = delete;
+  CycleBank &operator=(const CycleBank &) = delete;
+
+  // Storage and outputs, as for DampedOscillatorBank
+  bool Init(int capacity, tMempool *pool, int num_outputs = 1);
+  int capacity() const { return capacity_; }
+  int num_outputs() const { return num_outputs_; }
+  static constexpr size_t StorageBytes(int capacity, int num_outputs = 1) {
+    return (kNumArrays + 3 * (num_outputs - 1)) * simd_padded(capacity) *
+           sizeof(float) + SIMD_ALIGN;
+  }
+  static const int kMaxOutputs = 4;
+
+  // Rendering side, as for DampedOscillatorBank.  Reset() restarts every
+  // oscillator at zero phase and unit envelope.
+  void Process(float *const *out, size_t size);
+  void Process(float *out, size_t size) { Process(&out, size); }
+  void Process(const float *in, float *const *out, size_t size) {
+    Process(out, size);
+  }
+  void Reset();
+
+  // Coefficient side, as for DampedOscillatorBank
+  void set_freq(int i, float freq);
+  void set_decay(int i, float decay);
+  // Same as set_freq followed by set_decay, but without libm calls.
+  void set_freq_and_decay(int i, float freq, float decay);
+  void set_gain(int k, int i, float gain);
+  void set_gain(int i, float gain) { set_gain(0, i, gain); }
+  void set_input_gain(int i, float gain) {}
+  void set_num_active(int num_active);
+  // the coefficients of one oscillator, in this bank's form
+  struct Mode {
+    uint32_t inc;
+    float decay;
+  };
+  Mode mode(int i) const;
+  void set_mode(int i, const Mode &mode);
+  void Publish();
+  void set_sample_rate(float sr);
+  void set_ramp_length(int num_samples) {}
+
+ private:
+  // One slot of the triple buffer
+  struct Coefficients {
+    uint32_t *inc;
+    float *decay;  // envelope factor per sample
+    float *gain[kMaxOutputs];
+    int num_active;
+  };
+
+  template <int K, int kOutputs>
+  void ProcessOscillators(float *const *out, size_t size, int i,
+                          const Coefficients &c);
+  template <int kOutputs>
+  void Render(float *const *out, size_t size);
+
+  static const int kNumArrays = 11;  // with one output
+
+  float two_pi_by_sample_rate_;
+  float inv_sample_rate_times_two_to_32_;
+  int capacity_;
+  int num_outputs_;
+  int max_outputs_;  // that storage_ has room for
+  tMempool *pool_;  // that storage_ came from
+  char *storage_;
+
+  uint32_t *phase_;
+  float *envelope_;
+  Coefficients slots_[3];
+  TripleBuffer buffer_;
+};
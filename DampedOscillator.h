@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <stddef.h>
+
 class DampedOscillator {
  public:
   DampedOscillator() : DampedOscillator(1.0f) {}
@@ -23,6 +25,7 @@ class DampedOscillator {
   ~DampedOscillator();
 
   inline float Tick();
+  inline void Process(float *out, size_t size, float amplitude, float weight);
   void Reset();
 
   // change parameters
@@ -49,3 +52,23 @@ inline float DampedOscillator::Tick() {
   y_ = z + w;
   return y_;
 }
+
+// Render a block, adding amplitude * weight * y to each sample of out.  The
+// state is held in locals for the whole block, so when called once per mode
+// the per-sample cost is just the recurrence and a multiply-add.
+inline void DampedOscillator::Process(float *out, size_t size,
+                                      float amplitude, float weight) {
+  const float loop_gain = loop_gain_;
+  const float decay = decay_;
+  float x = x_;
+  float y = y_;
+  for (size_t i = 0; i < size; ++i) {
+    float w = decay * x;
+    float z = loop_gain * (y + w);
+    x = z - y;
+    y = z + w;
+    out[i] += y * amplitude * weight;
+  }
+  x_ = x;
+  y_ = y;
+}
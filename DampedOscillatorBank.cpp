@@ -0,0 +1,643 @@
+/*
+  DampedOscillatorBank.cpp
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+*/
+
+#include "DampedOscillatorBank.h"
+#include <math.h>
+#include <cassert>
+#include "FastMath.h"
+#include "leaflet.h"  // also defines TWO_PI
+
+// The loops over groups below must be unrolled so that the group state stays
+// in registers.
+#if defined(__GNUC__)
+#define UNROLL _Pragma("GCC unroll 8")
+#else
+#define UNROLL
+#endif
+
+DampedOscillatorBank::DampedOscillatorBank(float sample_rate)
+    : capacity_(0), num_outputs_(0), max_outputs_(0), pool_(nullptr),
+      storage_(nullptr), ramp_length_(0), ramp_remaining_(0),
+      retire_level_(1e-6f), retire_countdown_(kRetireInterval),
+      num_live_groups_(0) {
+  set_sample_rate(sample_rate);
+}
+
+DampedOscillatorBank::~DampedOscillatorBank() {
+  if (storage_ != nullptr) {
+    mpool_free(storage_, pool_);
+  }
+}
+
+bool DampedOscillatorBank::Init(int capacity, tMempool *pool,
+                                int num_outputs) {
+  assert(num_outputs > 0 && num_outputs <= kMaxOutputs);
+  num_outputs_ = num_outputs;
+  if (capacity > capacity_ || num_outputs > max_outputs_) {
+    if (storage_ != nullptr) {
+      mpool_free(storage_, pool_);
+    }
+    capacity_ = 0;
+    max_outputs_ = 0;
+    pool_ = pool;
+    storage_ = static_cast<char *>(
+        mpool_alloc(StorageBytes(capacity, num_outputs), pool));
+    if (storage_ == nullptr) {
+      num_outputs_ = 0;
+      return false;
+    }
+    float *p = reinterpret_cast<float *>(simd_align(storage_));
+    auto next_array = [&p, capacity]() {
+      float *array = p;
+      p += simd_padded(capacity);
+      return array;
+    };
+    loop_gain_ = next_array();
+    decay_ = next_array();
+    x_ = next_array();
+    y_ = next_array();
+    loop_gain_step_ = next_array();
+    decay_step_ = next_array();
+    turns_ratio_step_ = next_array();
+    turns_ratio_ = next_array();
+    live_groups_ = reinterpret_cast<int *>(next_array());
+    for (Coefficients &c : slots_) {
+      c.loop_gain = next_array();
+      c.turns_ratio = next_array();
+      c.decay = next_array();
+      for (int k = 0; k < num_outputs; ++k) {
+        c.gain[k] = next_array();
+      }
+      c.input_gain = next_array();
+    }
+    capacity_ = capacity;
+    max_outputs_ = num_outputs;
+  }
+  // including the padding, which ProcessStatic() renders (silently)
+  for (int i = 0; i < simd_padded(capacity_); ++i) {
+    decay_[i] = 1.0f;
+    loop_gain_[i] = 1.0f;
+    turns_ratio_[i] = 0.0f;  // not configured yet
+    loop_gain_step_[i] = 0.0f;
+    decay_step_[i] = 0.0f;
+    turns_ratio_step_[i] = 1.0f;
+    x_[i] = 0.0f;
+    y_[i] = 0.0f;
+  }
+  for (Coefficients &c : slots_) {
+    for (int i = 0; i < simd_padded(capacity_); ++i) {
+      c.loop_gain[i] = 1.0f;
+      c.turns_ratio[i] = 0.0f;
+      c.decay[i] = 1.0f;
+      for (int k = 0; k < num_outputs_; ++k) {
+        c.gain[k][i] = 0.0f;
+      }
+      c.input_gain[i] = 0.0f;
+    }
+    c.num_active = 0;
+  }
+  buffer_.Reset();
+  ramp_remaining_ = 0;
+  ReviveAll();
+  return true;
+}
+
+void DampedOscillatorBank::set_freq(int i, float freq_hz) {
+  float loop_gain = cosf(freq_hz * two_pi_by_sample_rate_);
+  Coefficients &c = slots_[buffer_.back()];
+  c.loop_gain[i] = loop_gain;
+  c.turns_ratio[i] = sqrt((1 - loop_gain) / (1 + loop_gain));
+}
+
+void DampedOscillatorBank::set_decay(int i, float decay) {
+  float r = exp(-decay * two_pi_by_sample_rate_);
+  slots_[buffer_.back()].decay[i] = r * r;
+}
+
+// With t = tan(w/2), the loop gain is cos(w) = 1 - 2 s^2 and the turns
+// ratio sqrt((1 - cos(w)) / (1 + cos(w))) is just t, where s and c are the
+// sine and cosine of w/2.  Needs one division and no sqrt.  The pitch
+// depends on 1 - cos(w), which is tiny for low notes: 1 - 2 s^2 rounds it
+// as well as cosf() does, whereas (c - s)(c + s) loses it to cancellation
+// (14 cents at 27.5 Hz; see accuracy -c).
+void DampedOscillatorBank::set_freq_and_decay(int i, float freq_hz,
+                                              float decay) {
+  float s, c;
+  fast_sincosf(0.5f * freq_hz * two_pi_by_sample_rate_, &s, &c);
+  Coefficients &back = slots_[buffer_.back()];
+  back.loop_gain[i] = 1.0f - 2.0f * s * s;
+  back.turns_ratio[i] = s / c;
+  back.decay[i] = fast_expf(-2.0f * decay * two_pi_by_sample_rate_);
+}
+
+void DampedOscillatorBank::set_gain(int k, int i, float gain) {
+  slots_[buffer_.back()].gain[k][i] = gain;
+}
+
+void DampedOscillatorBank::set_input_gain(int i, float gain) {
+  slots_[buffer_.back()].input_gain[i] = gain;
+}
+
+void DampedOscillatorBank::set_num_active(int num_active) {
+  slots_[buffer_.back()].num_active = num_active;
+}
+
+DampedOscillatorBank::Mode DampedOscillatorBank::mode(int i) const {
+  const Coefficients &back = slots_[buffer_.back()];
+  return {back.loop_gain[i], back.turns_ratio[i], back.decay[i]};
+}
+
+void DampedOscillatorBank::set_mode(int i, const Mode &mode) {
+  Coefficients &back = slots_[buffer_.back()];
+  back.loop_gain[i] = mode.loop_gain;
+  back.turns_ratio[i] = mode.turns_ratio;
+  back.decay[i] = mode.decay;
+}
+
+// The setters only change some of the coefficients, so the new back slot
+// starts as a copy of the one just published.
+void DampedOscillatorBank::Publish() {
+  const Coefficients &published = slots_[buffer_.Publish()];
+  Coefficients &back = slots_[buffer_.back()];
+  for (int i = 0; i < capacity_; ++i) {
+    back.loop_gain[i] = published.loop_gain[i];
+    back.turns_ratio[i] = published.turns_ratio[i];
+    back.decay[i] = published.decay[i];
+    for (int k = 0; k < num_outputs_; ++k) {
+      back.gain[k][i] = published.gain[k][i];
+    }
+    back.input_gain[i] = published.input_gain[i];
+  }
+  back.num_active = published.num_active;
+}
+
+// Set oscillators begin <= i < end to the start of a cycle with the
+// coefficients in the front slot, with no ramp
+void DampedOscillatorBank::Restart(int begin, int end) {
+  const Coefficients &c = slots_[buffer_.front()];
+  for (int i = begin; i < end; ++i) {
+    loop_gain_[i] = c.loop_gain[i];
+    decay_[i] = c.decay[i];
+    turns_ratio_[i] = c.turns_ratio[i];
+    loop_gain_step_[i] = 0.0f;
+    decay_step_[i] = 0.0f;
+    turns_ratio_step_[i] = 1.0f;
+    x_[i] = turns_ratio_[i];
+    y_[i] = 0.0f;
+  }
+}
+
+void DampedOscillatorBank::Reset() {
+  buffer_.Acquire();
+  Restart(0, capacity_);
+  ramp_remaining_ = 0;
+  ReviveAll();
+}
+
+// A ramp in progress is restarted from where it is, towards any new
+// coefficients, for the oscillators that are not restarted.
+void DampedOscillatorBank::Reset(int begin, int end) {
+  assert(0 <= begin && begin <= end && end <= capacity_);
+  if (buffer_.Acquire()) {
+    StartRamp();
+  }
+  Restart(begin, end);
+  // Groups that decayed elsewhere in the bank come back too, and are
+  // dropped again at the next check
+  ReviveAll();
+}
+
+void DampedOscillatorBank::ReviveAll() {
+  const int W = VecF::kWidth;
+  num_live_groups_ = 0;
+  for (int i = 0; i < capacity_; i += W) {
+    live_groups_[num_live_groups_++] = i;
+  }
+  retire_countdown_ = kRetireInterval;
+}
+
+int DampedOscillatorBank::num_live() const {
+  const int num_active = slots_[buffer_.front()].num_active;
+  int n = 0;
+  for (int e = 0; e < num_live_groups_; ++e) {
+    const int i = live_groups_[e];
+    if (i < num_active) {
+      n += i + VecF::kWidth < num_active ? VecF::kWidth : num_active - i;
+    }
+  }
+  return n;
+}
+
+// Have all the active oscillators of the group starting at i decayed below
+// retire_level_?  The amplitude of oscillator i is sqrt(y^2 + (x/t)^2),
+// with t its turns ratio (see DampedOscillator.h), and t = 0 (with x = 0)
+// for one that was never configured.
+bool DampedOscillatorBank::Decayed(int i, int num_active) const {
+  const float level_sq = retire_level_ * retire_level_;
+  const int end = i + VecF::kWidth < num_active ? i + VecF::kWidth
+                                                 : num_active;
+  for (int l = i; l < end; ++l) {
+    const float t_sq = turns_ratio_[l] * turns_ratio_[l];
+    if (y_[l] * y_[l] * t_sq + x_[l] * x_[l] > level_sq * t_sq) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Drop the decayed groups among those rendered from live_groups_, zeroing
+// their state.  Groups past num_active keep their state, to carry on if
+// they are rendered again (but not the oscillators past num_active in a
+// group that is dropped).
+void DampedOscillatorBank::Retire(const Coefficients &c) {
+  const int W = VecF::kWidth;
+  int num_kept = 0;
+  for (int e = 0; e < num_live_groups_; ++e) {
+    const int i = live_groups_[e];
+    if (i >= c.num_active || !Decayed(i, c.num_active)) {
+      live_groups_[num_kept++] = i;
+      continue;
+    }
+    for (int l = i; l < i + W; ++l) {
+      x_[l] = 0.0f;
+      y_[l] = 0.0f;
+    }
+  }
+  num_live_groups_ = num_kept;
+}
+
+void DampedOscillatorBank::set_sample_rate(float sr) {
+  two_pi_by_sample_rate_ = TWO_PI / sr;
+}
+
+// Move from the current coefficients to those in the front slot.  With a
+// ramp, oscillators that will be rendered get per-sample increments; the x
+// state is scaled by a constant factor each sample, so that over the ramp
+// it is scaled by the ratio of new to old turns ratio, which keeps the
+// amplitude continuous.  Without a ramp, and for oscillators that are not
+// rendered, the coefficients jump straight to the new values (with the same
+// scaling of x).
+void DampedOscillatorBank::StartRamp() {
+  const Coefficients &c = slots_[buffer_.front()];
+  const int num_ramped = ramp_length_ > 0 ? c.num_active : 0;
+  const float inv_length = ramp_length_ > 0 ? 1.0f / ramp_length_ : 0.0f;
+  for (int i = 0; i < capacity_; ++i) {
+    float ratio = (turns_ratio_[i] > 0.0f)
+                  ? c.turns_ratio[i] / turns_ratio_[i] : 1.0f;
+    if (i < num_ramped) {
+      loop_gain_step_[i] = (c.loop_gain[i] - loop_gain_[i]) * inv_length;
+      decay_step_[i] = (c.decay[i] - decay_[i]) * inv_length;
+      turns_ratio_step_[i] = fast_expf(fast_logf(ratio) * inv_length);
+    } else {
+      loop_gain_[i] = c.loop_gain[i];
+      decay_[i] = c.decay[i];
+      x_[i] *= ratio;
+      loop_gain_step_[i] = 0.0f;
+      decay_step_[i] = 0.0f;
+      turns_ratio_step_[i] = 1.0f;
+    }
+    turns_ratio_[i] = c.turns_ratio[i];
+  }
+  ramp_remaining_ = num_ramped > 0 ? ramp_length_ : 0;
+}
+
+// Advance K groups of VecF::kWidth oscillators, starting at indices
+// groups[0], ..., groups[K - 1], by n samples, adding the outputs weighted
+// by gains[k] to acc[k] for each of kOutputs outputs.  The groups are
+// interleaved so that their (serial) recurrences can overlap in the
+// pipeline.  If kRamp is set, the coefficients are also stepped each
+// sample.  If kInput is set, in drives the oscillators through
+// input_gains.
+template <int K, bool kRamp, int kOutputs, bool kInput>
+inline void DampedOscillatorBank::ProcessGroups(VecF (*acc)[kMaxChunk],
+                                                size_t n, const int *groups,
+                                                const float *const *gains,
+                                                const float *in,
+                                                const float *input_gains) {
+  VecF loop_gain[K], decay[K], gain[kOutputs][K], x[K], y[K];
+  VecF loop_gain_step[K], decay_step[K], turns_ratio_step[K];
+  VecF input_gain[K];
+  UNROLL
+  for (int k = 0; k < K; ++k) {
+    int idx = groups[k];
+    loop_gain[k] = vload(&loop_gain_[idx]);
+    decay[k] = vload(&decay_[idx]);
+    UNROLL
+    for (int o = 0; o < kOutputs; ++o) {
+      gain[o][k] = vload(&gains[o][idx]);
+    }
+    if (kInput) {
+      input_gain[k] = vload(&input_gains[idx]) * (vset1(1.0f) - decay[k]);
+    }
+    x[k] = vload(&x_[idx]);
+    y[k] = vload(&y_[idx]);
+    if (kRamp) {
+      loop_gain_step[k] = vload(&loop_gain_step_[idx]);
+      decay_step[k] = vload(&decay_step_[idx]);
+      turns_ratio_step[k] = vload(&turns_ratio_step_[idx]);
+    }
+  }
+  for (size_t j = 0; j < n; ++j) {
+    VecF sum[kOutputs];
+    UNROLL
+    for (int o = 0; o < kOutputs; ++o) {
+      sum[o] = acc[o][j];
+    }
+    const VecF u = kInput ? vset1(in[j]) : vset1(0.0f);
+    UNROLL
+    for (int k = 0; k < K; ++k) {
+      if (kRamp) {
+        loop_gain[k] = loop_gain[k] + loop_gain_step[k];
+        decay[k] = decay[k] + decay_step[k];
+        x[k] = x[k] * turns_ratio_step[k];
+      }
+      VecF w = decay[k] * x[k];
+      VecF z = loop_gain[k] * (y[k] + w);
+      x[k] = z - y[k];
+      y[k] = z + w;
+      if (kInput) {
+        y[k] = y[k] + input_gain[k] * u;
+      }
+      UNROLL
+      for (int o = 0; o < kOutputs; ++o) {
+        sum[o] = sum[o] + y[k] * gain[o][k];
+      }
+    }
+    UNROLL
+    for (int o = 0; o < kOutputs; ++o) {
+      acc[o][j] = sum[o];
+    }
+  }
+  UNROLL
+  for (int k = 0; k < K; ++k) {
+    int idx = groups[k];
+    vstore(&x_[idx], x[k]);
+    vstore(&y_[idx], y[k]);
+    if (kRamp) {
+      vstore(&loop_gain_[idx], loop_gain[k]);
+      vstore(&decay_[idx], decay[k]);
+    }
+  }
+}
+
+template <bool kRamp, int kOutputs, bool kInput>
+void DampedOscillatorBank::ProcessBlock(const float *in, float *const *out,
+                                        size_t size, const Coefficients &c) {
+  const int W = VecF::kWidth;
+  const int num_osc = c.num_active;
+  const int K = kRamp ? 2 : 4;  // groups processed together
+  const int num_vec = (W > 1) ? num_osc / W * W : 0;
+  // live_groups_[e] for e < num_vec_groups are whole groups
+  int num_vec_groups = 0;
+  while (num_vec_groups < num_live_groups_ &&
+         live_groups_[num_vec_groups] < num_vec) {
+    ++num_vec_groups;
+  }
+
+  // Vector part: W oscillators per instruction.  Each lane of acc[k][j]
+  // holds a partial sum for sample j of output k, reduced once at the end
+  // of the chunk.
+  if (num_vec_groups > 0) {
+    VecF acc[kOutputs][kMaxChunk];
+    for (size_t start = 0; start < size; start += kMaxChunk) {
+      size_t n = size - start < kMaxChunk ? size - start : kMaxChunk;
+      for (int o = 0; o < kOutputs; ++o) {
+        for (size_t j = 0; j < n; ++j) {
+          acc[o][j] = vset1(0.0f);
+        }
+      }
+      const float *chunk_in = kInput ? in + start : nullptr;
+      int e = 0;
+      for (; e + K <= num_vec_groups; e += K) {
+        ProcessGroups<K, kRamp, kOutputs, kInput>(
+            acc, n, &live_groups_[e], c.gain, chunk_in, c.input_gain);
+      }
+      for (; e < num_vec_groups; ++e) {
+        ProcessGroups<1, kRamp, kOutputs, kInput>(
+            acc, n, &live_groups_[e], c.gain, chunk_in, c.input_gain);
+      }
+      for (int o = 0; o < kOutputs; ++o) {
+        for (size_t j = 0; j < n; ++j) {
+          out[o][start + j] += vsum(acc[o][j]);
+        }
+      }
+    }
+  }
+
+  // Scalar part: one oscillator at a time, with its state in registers for
+  // the whole block.  The live oscillators past num_vec, which are in (at
+  // most) one group unless W = 1.
+  for (int e = num_vec_groups; e < num_live_groups_; ++e) {
+    const int group = live_groups_[e];
+    if (group >= num_osc) {
+      break;
+    }
+    const int group_end = group + W < num_osc ? group + W : num_osc;
+    for (int i = group; i < group_end; ++i) {
+      float loop_gain = loop_gain_[i];
+      float decay = decay_[i];
+      float gain[kOutputs];
+      for (int o = 0; o < kOutputs; ++o) {
+        gain[o] = c.gain[o][i];
+      }
+      const float input_gain =
+          kInput ? c.input_gain[i] * (1.0f - decay) : 0.0f;
+      float x = x_[i];
+      float y = y_[i];
+      for (size_t j = 0; j < size; ++j) {
+        if (kRamp) {
+          loop_gain += loop_gain_step_[i];
+          decay += decay_step_[i];
+          x *= turns_ratio_step_[i];
+        }
+        float w = decay * x;
+        float z = loop_gain * (y + w);
+        x = z - y;
+        y = z + w;
+        if (kInput) {
+          y += input_gain * in[j];
+        }
+        UNROLL
+        for (int o = 0; o < kOutputs; ++o) {
+          out[o][j] += y * gain[o];
+        }
+      }
+      x_[i] = x;
+      y_[i] = y;
+      if (kRamp) {
+        loop_gain_[i] = loop_gain;
+        decay_[i] = decay;
+      }
+    }
+  }
+}
+
+// Render with N active oscillators at most.  Each group of W oscillators
+// up to the last active one is rendered, with the gains (and input gains)
+// past num_active zeroed in a local copy; the groups go in chunks of K,
+// with K a divisor of the number of groups, so the whole pattern is fixed
+// at compile time.
+// Oscillators past num_active that share a chunk with active ones keep
+// running, silently, as do the padding lanes (whose state is zero).  Every
+// group is rendered, decayed or not: the pattern has no room for
+// live_groups_.
+template <bool kRamp, int N, int kOutputs, bool kInput>
+void DampedOscillatorBank::ProcessBlockStatic(const float *in,
+                                              float *const *out, size_t size,
+                                              const Coefficients &c) {
+  const int W = VecF::kWidth;
+  const int kLanes = simd_padded(N > 0 ? N : 1);
+  const int kGroups = kLanes / W;
+  const int kMaxK = kRamp ? 2 : 4;  // as in ProcessBlock
+  const int K = (kGroups % kMaxK == 0) ? kMaxK : (kGroups % 2 == 0) ? 2 : 1;
+  const int num_active = c.num_active < N ? c.num_active : N;
+  const int num_chunks = (num_active + K * W - 1) / (K * W);
+  if (num_chunks == 0) {
+    return;
+  }
+  alignas(SIMD_ALIGN) float gains[kOutputs][kLanes];
+  const float *gain_arrays[kOutputs];
+  for (int o = 0; o < kOutputs; ++o) {
+    for (int i = 0; i < kLanes; ++i) {
+      gains[o][i] = i < num_active ? c.gain[o][i] : 0.0f;
+    }
+    gain_arrays[o] = gains[o];
+  }
+  int groups[kGroups];
+  for (int k = 0; k < kGroups; ++k) {
+    groups[k] = k * W;
+  }
+  alignas(SIMD_ALIGN) float input_gains[kInput ? kLanes : 1];
+  if (kInput) {
+    for (int i = 0; i < kLanes; ++i) {
+      input_gains[i] = i < num_active ? c.input_gain[i] : 0.0f;
+    }
+  }
+  VecF acc[kOutputs][kMaxChunk];
+  for (size_t start = 0; start < size; start += kMaxChunk) {
+    size_t n = size - start < kMaxChunk ? size - start : kMaxChunk;
+    for (int o = 0; o < kOutputs; ++o) {
+      for (size_t j = 0; j < n; ++j) {
+        acc[o][j] = vset1(0.0f);
+      }
+    }
+    const float *chunk_in = kInput ? in + start : nullptr;
+    for (int k = 0; k < num_chunks; ++k) {
+      ProcessGroups<K, kRamp, kOutputs, kInput>(acc, n, &groups[k * K],
+                                                gain_arrays, chunk_in,
+                                                input_gains);
+    }
+    for (int o = 0; o < kOutputs; ++o) {
+      for (size_t j = 0; j < n; ++j) {
+        out[o][start + j] += vsum(acc[o][j]);
+      }
+    }
+  }
+}
+
+// New coefficients are picked up at the start of a block, unless a ramp is
+// still running.  N > 0 selects ProcessBlockStatic<N>.  Decayed groups are
+// dropped every kRetireInterval samples (at the start of the block that
+// gets there), unless there is an input, which may bring any of them back
+// to life.
+template <int N, int kOutputs, bool kInput>
+inline void DampedOscillatorBank::Render(const float *in, float *const *out,
+                                         size_t size) {
+  if (ramp_remaining_ == 0 && buffer_.Acquire()) {
+    StartRamp();
+  }
+  const Coefficients &c = slots_[buffer_.front()];
+  if (N == 0) {
+    if (kInput) {
+      if (num_live_groups_ * VecF::kWidth < capacity_) {
+        ReviveAll();
+      }
+    } else {
+      retire_countdown_ -= size;
+      if (retire_countdown_ <= 0) {
+        retire_countdown_ = kRetireInterval;
+        Retire(c);
+      }
+    }
+  }
+  float *rest[kOutputs];
+  for (int o = 0; o < kOutputs; ++o) {
+    rest[o] = out[o];
+  }
+  if (ramp_remaining_ > 0) {
+    size_t n = size < static_cast<size_t>(ramp_remaining_)
+               ? size : ramp_remaining_;
+    if (N > 0) {
+      ProcessBlockStatic<true, N, kOutputs, kInput>(in, rest, n, c);
+    } else {
+      ProcessBlock<true, kOutputs, kInput>(in, rest, n, c);
+    }
+    ramp_remaining_ -= n;
+    for (int o = 0; o < kOutputs; ++o) {
+      rest[o] += n;
+    }
+    if (kInput) {
+      in += n;
+    }
+    size -= n;
+  }
+  if (N > 0) {
+    ProcessBlockStatic<false, N, kOutputs, kInput>(in, rest, size, c);
+  } else {
+    ProcessBlock<false, kOutputs, kInput>(in, rest, size, c);
+  }
+}
+
+// The kernels are compiled for each number of outputs
+template <int N, bool kInput>
+void DampedOscillatorBank::RenderOutputs(const float *in, float *const *out,
+                                         size_t size) {
+  static_assert(kMaxOutputs == 4, "one case per number of outputs");
+  switch (num_outputs_) {
+    case 1: Render<N, 1, kInput>(in, out, size); break;
+    case 2: Render<N, 2, kInput>(in, out, size); break;
+    case 3: Render<N, 3, kInput>(in, out, size); break;
+    case 4: Render<N, 4, kInput>(in, out, size); break;
+    default: break;
+  }
+}
+
+void DampedOscillatorBank::Process(float *const *out, size_t size) {
+  RenderOutputs<0, false>(nullptr, out, size);
+}
+
+void DampedOscillatorBank::Process(const float *in, float *const *out,
+                                   size_t size) {
+  RenderOutputs<0, true>(in, out, size);
+}
+
+template <int N>
+void DampedOscillatorBank::ProcessStatic(float *const *out, size_t size) {
+  assert(N <= capacity_);
+  RenderOutputs<N, false>(nullptr, out, size);
+}
+
+template <int N>
+void DampedOscillatorBank::ProcessStatic(const float *in, float *const *out,
+                                         size_t size) {
+  assert(N <= capacity_);
+  RenderOutputs<N, true>(in, out, size);
+}
+
+// the sizes of StaticStiffString instantiated in StiffString.cpp
+template void DampedOscillatorBank::ProcessStatic<16>(float *const *, size_t);
+template void DampedOscillatorBank::ProcessStatic<16>(const float *,
+                                                      float *const *, size_t);
+template void DampedOscillatorBank::ProcessStatic<32>(float *const *, size_t);
+template void DampedOscillatorBank::ProcessStatic<32>(const float *,
+                                                      float *const *, size_t);
+template void DampedOscillatorBank::ProcessStatic<60>(float *const *, size_t);
+template void DampedOscillatorBank::ProcessStatic<60>(const float *,
+                                                      float *const *, size_t);
+template void DampedOscillatorBank::ProcessStatic<128>(float *const *, size_t);
+template void DampedOscillatorBank::ProcessStatic<128>(const float *,
+                                                       float *const *, size_t);
@@ -0,0 +1,214 @@
+/*
+  DampedOscillatorBank.h
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+
+  A bank of damped digital waveguide oscillators (see DampedOscillator.h),
+  stored as a structure of arrays so that several oscillators can be updated
+  per instruction.  The per-sample state and coefficients each live in their
+  own contiguous, aligned array; the parameters that are only needed when a
+  frequency changes are kept apart from them.  All of them are carved from
+  one block of memory, sized for the number of oscillators and allocated
+  from a leaflet pool by Init().
+
+  The coefficients may be computed in a different thread from the one that
+  renders (e.g. the main loop and the audio callback).  The setters write a
+  back buffer of coefficients and output gains, which Publish() hands over
+  as a whole; Process() and Reset() pick up the latest published set.  The
+  oscillator state belongs to the rendering side alone.  See TripleBuffer.h.
+
+  New coefficients take effect at the start of the next block by default.
+  With a nonzero ramp length, Process() instead moves the loop gain, decay
+  and turns ratio linearly (geometrically, for the turns ratio) toward them
+  over that many samples.  A ramp runs to completion before the next one
+  starts, so parameters are effectively sampled once per ramp and
+  interpolated in between.
+
+  A bank may have several outputs (up to kMaxOutputs), each with its own
+  gain per oscillator, such as the pickups of a string (see StiffString.h).
+  They are all rendered in the same pass over the oscillators, so each extra
+  output only costs a multiply-add per oscillator and sample.
+
+  Process() may also take an input signal, which drives every oscillator
+  through its own input gain, as a force on a resonator.  The gain sets the
+  oscillator's steady response to an input at its frequency, relative to
+  the input (independent of the decay, so that lightly damped oscillators
+  respond to the same level as others, only more slowly); undamped ones
+  ignore the input.  Each oscillator's input is scaled by its loss per
+  sample, 1 - decay, once per block, so it costs a multiply-add per
+  oscillator and sample.  See StringBank.h.
+
+  Process() keeps a list of the groups of oscillators (of VecF::kWidth
+  each, so single oscillators on a scalar build) that are still sounding,
+  in order, and renders only those.  Every kRetireInterval samples, it
+  estimates the amplitude of each rendered oscillator from its state and
+  drops the groups in which all of them have decayed below a threshold
+  (-120 dB by default; see set_retire_level()), zeroing their state, so a
+  sustained or released note gets cheaper as its modes die away, and its
+  state never sinks into slow subnormal numbers.  Reset() brings every
+  group back.  Oscillators driven by an input are never dropped.
+
+  ProcessStatic<N>() is Process() for a bank that never renders more than N
+  oscillators, with N known at compile time (see StaticStiffString): it
+  renders whole SIMD groups of oscillators, padding the last one with zero
+  gains, in a fixed pattern of interleaved groups, with no scalar tail.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include "Simd.h"
+#include "TripleBuffer.h"
+
+struct tMempool;  // leaflet.h
+
+class DampedOscillatorBank {
+ public:
+  DampedOscillatorBank() : DampedOscillatorBank(1.0f) {}
+  explicit DampedOscillatorBank(float sample_rate);
+  ~DampedOscillatorBank();
+  DampedOscillatorBank(const DampedOscillatorBank &) = delete;
+  DampedOscillatorBank &operator=(const DampedOscillatorBank &) = delete;
+
+  // Allocate storage for capacity oscillators with num_outputs outputs from
+  // pool, and reset them all.  Storage is only reallocated if it grows.
+  // Not for the audio callback.  Returns false (with no oscillators) if pool
+  // is out of memory.
+  bool Init(int capacity, tMempool *pool, int num_outputs = 1);
+  int capacity() const { return capacity_; }
+  int num_outputs() const { return num_outputs_; }
+  // pool memory allocated by Init(capacity, pool, num_outputs)
+  static constexpr size_t StorageBytes(int capacity, int num_outputs = 1) {
+    return (kNumArrays + 3 * (num_outputs - 1)) * simd_padded(capacity) *
+           sizeof(float) + SIMD_ALIGN;
+  }
+  static const int kMaxOutputs = 4;
+
+  // Rendering side.  Render a block, adding sum_i gain_ki * y_i to each
+  // sample of out[k] for each output k, over the active oscillators.
+  void Process(float *const *out, size_t size);
+  // Process() for a bank with one output
+  void Process(float *out, size_t size) { Process(&out, size); }
+  // Process(), also adding input_gain_i * (1 - decay_i) * in[j] to the
+  // state y_i of each oscillator at each sample j
+  void Process(const float *in, float *const *out, size_t size);
+  // Process(), for at most N active oscillators (N <= capacity()).
+  // Instantiated in DampedOscillatorBank.cpp for the sizes of
+  // StaticStiffString in StiffString.cpp.
+  template <int N>
+  void ProcessStatic(float *const *out, size_t size);
+  template <int N>
+  void ProcessStatic(const float *in, float *const *out, size_t size);
+  // Restart every oscillator (as if plucked) with the latest coefficients.
+  void Reset();
+  // Restart oscillators begin <= i < end only.  The others carry on, with
+  // the latest coefficients applied as at the start of a block.
+  void Reset(int begin, int end);
+
+  // Coefficient side: change oscillator i in the back buffer
+  void set_freq(int i, float freq);
+  void set_decay(int i, float decay);
+  // Set frequency and decay together (same units as set_freq and
+  // set_decay), using the approximations in FastMath.h rather than libm.
+  // freq must be below the Nyquist frequency.
+  void set_freq_and_decay(int i, float freq, float decay);
+  // gain of oscillator i in output k (or in the only output)
+  void set_gain(int k, int i, float gain);
+  void set_gain(int i, float gain) { set_gain(0, i, gain); }
+  // response of oscillator i to the input of Process() (see above)
+  void set_input_gain(int i, float gain);
+  // render oscillators 0 <= i < num_active
+  void set_num_active(int num_active);
+  // The frequency and decay coefficients of oscillator i in the back
+  // buffer, to be copied to the same oscillator of a bank with the same
+  // sample rate (see NoteTable.h)
+  struct Mode {
+    float loop_gain;
+    float turns_ratio;
+    float decay;
+  };
+  Mode mode(int i) const;
+  void set_mode(int i, const Mode &mode);
+  // Hand the back buffer to the rendering side
+  void Publish();
+  void set_sample_rate(float sr);
+  // number of samples over which parameter changes are smoothed (0 = off)
+  void set_ramp_length(int num_samples) { ramp_length_ = num_samples; }
+  // Stop rendering oscillators once their amplitude (1 at the start of a
+  // cycle) falls below this level (see above).  Rendering side.
+  void set_retire_level(float level) { retire_level_ = level; }
+  // Active oscillators that Process() still renders (in whole groups).
+  // Rendering side.
+  int num_live() const;
+
+ private:
+  // Longest block rendered in one pass of the vector kernel.  Longer blocks
+  // are split into chunks of this size.
+  static const size_t kMaxChunk = 64;
+  // samples between checks for decayed oscillators
+  static const int kRetireInterval = 256;
+
+  // One slot of the triple buffer
+  struct Coefficients {
+    float *loop_gain;
+    float *turns_ratio;
+    float *decay;
+    float *gain[kMaxOutputs];
+    float *input_gain;
+    int num_active;
+  };
+
+  template <int K, bool kRamp, int kOutputs, bool kInput>
+  void ProcessGroups(VecF (*acc)[kMaxChunk], size_t n, const int *groups,
+                     const float *const *gains, const float *in,
+                     const float *input_gains);
+  template <bool kRamp, int kOutputs, bool kInput>
+  void ProcessBlock(const float *in, float *const *out, size_t size,
+                    const Coefficients &c);
+  template <bool kRamp, int N, int kOutputs, bool kInput>
+  void ProcessBlockStatic(const float *in, float *const *out, size_t size,
+                          const Coefficients &c);
+  template <int N, int kOutputs, bool kInput>
+  void Render(const float *in, float *const *out, size_t size);
+  template <int N, bool kInput>
+  void RenderOutputs(const float *in, float *const *out, size_t size);
+  void StartRamp();
+  void Restart(int begin, int end);
+  bool Decayed(int group, int num_active) const;
+  void Retire(const Coefficients &c);
+  void ReviveAll();
+
+  static const int kNumArrays = 24;  // with one output
+
+  float two_pi_by_sample_rate_;
+  int capacity_;
+  int num_outputs_;
+  int max_outputs_;  // that storage_ has room for
+  tMempool *pool_;  // that storage_ came from
+  char *storage_;
+  int ramp_length_;
+  int ramp_remaining_;
+  float retire_level_;
+  int retire_countdown_;  // samples until the next check
+
+  // hot: coefficients and state used every sample (SIMD_ALIGN aligned)
+  float *loop_gain_;
+  float *decay_;
+  float *x_;
+  float *y_;
+
+  // per-sample increments while ramping (the turns ratio step is a factor)
+  float *loop_gain_step_;
+  float *decay_step_;
+  float *turns_ratio_step_;
+
+  // first oscillator of each group still rendered, in increasing order
+  int *live_groups_;
+  int num_live_groups_;
+
+  // cold: only used when the coefficients change
+  float *turns_ratio_;
+  Coefficients slots_[3];
+  TripleBuffer buffer_;
+};
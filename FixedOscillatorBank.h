@@ -0,0 +1,130 @@
+/*
+  FixedOscillatorBank.h
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+
+  Fixed-point version of DampedOscillatorBank, for cores with a weak FPU or
+  none: the same waveguide recurrence, with Q31 coefficients and 32-bit
+  integer state, and the weighted sum of the outputs accumulated in 64 bits
+  and converted to float once per sample.  It has the same interface, so it
+  can be the oscillator policy of BasicStiffString (FixedStiffString).  The
+  coefficients are still computed in float, on the coefficient side.
+
+  The state is scaled so that a unit-amplitude oscillator uses a quarter of
+  the integer range.  The x state of the waveguide has amplitude equal to
+  the turns ratio tan(w/2), and y + x needs 1 + tan(w/2), so modes are only
+  rendered while tan(w/2) <= kMaxTurnsRatio, i.e. below about 0.4 times the
+  sample rate; higher ones are silent.  Within that range the recurrence
+  cannot overflow.  Coefficient changes are applied at once, with the same
+  rescaling of x as in DampedOscillatorBank, so set_ramp_length() has no
+  effect.  The input of Process() is clipped to [-1, 1], converted to the
+  state's scale and added to y in the same way as in DampedOscillatorBank.
+  The response to it counts against the same headroom.  A mode's response
+  builds up as fast as its pluck dies away, so with input gains of at most
+  1 the two together stay within about unit amplitude.  As a backstop, the
+  additions of the recurrence saturate, so a mode pushed past its headroom
+  by rounding clips rather than wrapping around.  testfixed.cpp compares
+  the output with the float version.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "Simd.h"
+#include "TripleBuffer.h"
+
+struct tMempool;  // leaflet.h
+
+class FixedOscillatorBank {
+ public:
+  FixedOscillatorBank() : FixedOscillatorBank(1.0f) {}
+  explicit FixedOscillatorBank(float sample_rate);
+  ~FixedOscillatorBank();
+  FixedOscillatorBank(const FixedOscillatorBank &) = delete;
+  FixedOscillatorBank &operator=(const FixedOscillatorBank &) = delete;
+
+  // Storage and outputs, as for DampedOscillatorBank
+  bool Init(int capacity, tMempool *pool, int num_outputs = 1);
+  int capacity() const { return capacity_; }
+  int num_outputs() const { return num_outputs_; }
+  static constexpr size_t StorageBytes(int capacity, int num_outputs = 1) {
+    return (kNumArrays + 3 * (num_outputs - 1)) * simd_padded(capacity) *
+           sizeof(int32_t) + SIMD_ALIGN;
+  }
+  static const int kMaxOutputs = 4;
+
+  // Rendering side, as for DampedOscillatorBank
+  void Process(float *const *out, size_t size);
+  void Process(float *out, size_t size) { Process(&out, size); }
+  void Process(const float *in, float *const *out, size_t size);
+  void Reset();
+
+  // Coefficient side, as for DampedOscillatorBank
+  void set_freq(int i, float freq);
+  void set_decay(int i, float decay);
+  void set_freq_and_decay(int i, float freq, float decay);
+  // |gain| must be below 1
+  void set_gain(int k, int i, float gain);
+  void set_gain(int i, float gain) { set_gain(0, i, gain); }
+  // |gain| must be at most 1
+  void set_input_gain(int i, float gain);
+  void set_num_active(int num_active);
+  // the coefficients of one oscillator, in this bank's form
+  struct Mode {
+    int32_t loop_gain;  // Q31
+    int32_t decay;      // Q31
+    float turns_ratio;
+  };
+  Mode mode(int i) const;
+  void set_mode(int i, const Mode &mode);
+  void Publish();
+  void set_sample_rate(float sr);
+  void set_ramp_length(int num_samples) {}
+
+  // Largest turns ratio rendered; see above
+  static constexpr float kMaxTurnsRatio = 3.0f;
+  // Fixed-point value of a unit-amplitude state
+  static constexpr float kStateScale = 536870912.0f;  // 2^29
+
+ private:
+  // Longest block rendered in one pass.  Longer blocks are split into
+  // chunks of this size.
+  static const size_t kMaxChunk = 64;
+
+  // One slot of the triple buffer
+  struct Coefficients {
+    int32_t *loop_gain;            // Q31
+    int32_t *decay;                // Q31
+    int32_t *gain[kMaxOutputs];    // Q31
+    int32_t *input_gain;           // Q31
+    float *turns_ratio;  // 0 for modes that are not rendered
+    int num_active;
+  };
+
+  template <int K, int kOutputs, bool kInput>
+  void ProcessOscillators(int64_t (*acc)[kMaxChunk], const int32_t *in,
+                          size_t n, int i, const Coefficients &c);
+  template <int kOutputs, bool kInput>
+  void Render(const float *in, float *const *out, size_t size);
+  template <bool kInput>
+  void RenderOutputs(const float *in, float *const *out, size_t size);
+  void Update();
+  void SetFreq(int i, float s, float c);
+
+  static const int kNumArrays = 18;  // with one output
+
+  float two_pi_by_sample_rate_;
+  int capacity_;
+  int num_outputs_;
+  int max_outputs_;  // that storage_ has room for
+  tMempool *pool_;  // that storage_ came from
+  char *storage_;
+
+  int32_t *x_;
+  int32_t *y_;
+  float *turns_ratio_;  // of the coefficients in use
+  Coefficients slots_[3];
+  TripleBuffer buffer_;
+};
@@ -0,0 +1,164 @@
+/*
+  LoadMeter.cpp
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+*/
+
+#include "LoadMeter.h"
+#include <math.h>
+#if !defined(__arm__)
+#include <time.h>
+#endif
+
+// Governor timing, in seconds: wait long enough after a change for the
+// average load to reflect it, and much longer before adding modes back.
+const float SHED_HOLD_TIME = 2 * LoadMeter::kAverageTime;
+const float RESTORE_HOLD_TIME = 0.5f;
+// Modes are added back once the average load is below this fraction of
+// the target.
+const float RESTORE_FRACTION = 0.8f;
+// Number of steps between the fewest and the most modes
+const int GOVERNOR_STEPS = 8;
+
+#if defined(__arm__)
+
+// Cortex-M7 debug registers (ARMv7-M Architecture Reference Manual, C1)
+inline volatile uint32_t &Register(uintptr_t address) {
+  return *reinterpret_cast<volatile uint32_t *>(address);
+}
+volatile uint32_t &DEMCR = Register(0xE000EDFC);
+volatile uint32_t &DWT_CTRL = Register(0xE0001000);
+volatile uint32_t &DWT_CYCCNT = Register(0xE0001004);
+volatile uint32_t &DWT_LAR = Register(0xE0001FB0);
+
+extern "C" uint32_t SystemCoreClock;  // CMSIS: CPU clock in Hz
+
+uint32_t LoadMeter::Now() {
+  return DWT_CYCCNT;
+}
+
+float LoadMeter::TicksPerSecond() {
+  return static_cast<float>(SystemCoreClock);
+}
+
+static void StartClock() {
+  DEMCR |= 1u << 24;   // TRCENA: enable the DWT
+  DWT_LAR = 0xC5ACCE55;  // unlock it (needed on the STM32H7)
+  DWT_CYCCNT = 0;
+  DWT_CTRL |= 1u;      // CYCCNTENA
+}
+
+#else
+
+// Nanoseconds, modulo 2^32; differences are correct for up to 4 seconds.
+uint32_t LoadMeter::Now() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return static_cast<uint32_t>(t.tv_sec * 1000000000ull + t.tv_nsec);
+}
+
+float LoadMeter::TicksPerSecond() {
+  return 1e9f;
+}
+
+static void StartClock() {}
+
+#endif
+
+void LoadMeter::Init(float sample_rate, size_t block_size) {
+  StartClock();
+  blocks_per_second_ = sample_rate / block_size;
+  inv_ticks_per_block_ = blocks_per_second_ / TicksPerSecond();
+  average_coeff_ = 1.0f - expf(-1.0f / (kAverageTime * blocks_per_second_));
+  Reset();
+}
+
+void LoadMeter::Reset() {
+  load_.store(0.0f, std::memory_order_relaxed);
+  average_load_.store(0.0f, std::memory_order_relaxed);
+  peak_load_.store(0.0f, std::memory_order_relaxed);
+  num_blocks_.store(0, std::memory_order_relaxed);
+  num_overruns_.store(0, std::memory_order_relaxed);
+  total_ticks_ = 0;
+}
+
+// Only this thread writes the statistics, so they are read back with
+// relaxed loads and written with plain (atomic) stores.
+void LoadMeter::BlockEnd() {
+  // unsigned difference, so the counter may wrap between start and end
+  const uint32_t ticks = Now() - start_;
+  const float load = ticks * inv_ticks_per_block_;
+  const float average = average_load();
+  load_.store(load, std::memory_order_relaxed);
+  average_load_.store(average + average_coeff_ * (load - average),
+                      std::memory_order_relaxed);
+  if (load > peak_load()) {
+    peak_load_.store(load, std::memory_order_relaxed);
+  }
+  if (load > 1.0f) {
+    num_overruns_.store(num_overruns() + 1, std::memory_order_relaxed);
+  }
+  total_ticks_ += ticks;
+  num_blocks_.store(num_blocks() + 1, std::memory_order_relaxed);
+}
+
+float LoadMeter::mean_load() const {
+  if (num_blocks() == 0) {
+    return 0.0f;
+  }
+  return total_ticks_ * inv_ticks_per_block_ / num_blocks();
+}
+
+void ModeGovernor::Init(float blocks_per_second, int min_modes, int max_modes,
+                        float target_load) {
+  min_modes_ = min_modes;
+  max_modes_ = max_modes;
+  modes_ = max_modes;
+  target_load_ = target_load;
+  step_ = (max_modes - min_modes + GOVERNOR_STEPS - 1) / GOVERNOR_STEPS;
+  if (step_ < 1) {
+    step_ = 1;
+  }
+  shed_hold_ = static_cast<int>(SHED_HOLD_TIME * blocks_per_second);
+  restore_hold_ = static_cast<int>(RESTORE_HOLD_TIME * blocks_per_second);
+  hold_ = 0;
+  last_blocks_ = 0;
+  last_overruns_ = 0;
+}
+
+bool ModeGovernor::Update(const LoadMeter &meter) {
+  // Time is counted in blocks rendered since the last call, so it does not
+  // matter how often this is called.  An overrun sheds modes at once;
+  // otherwise go by the average.
+  const uint32_t blocks = meter.num_blocks();
+  const uint32_t overruns = meter.num_overruns();
+  const bool overrun = overruns != last_overruns_;
+  hold_ -= static_cast<int>(blocks - last_blocks_);
+  if (hold_ < 0) {
+    hold_ = 0;
+  }
+  last_blocks_ = blocks;
+  last_overruns_ = overruns;
+  if (hold_ > 0 && !overrun) {
+    return false;
+  }
+  const float load = meter.average_load();
+  if ((overrun || load > target_load_) && modes_ > min_modes_) {
+    modes_ -= step_;
+    if (modes_ < min_modes_) {
+      modes_ = min_modes_;
+    }
+    hold_ = shed_hold_;
+    return true;
+  }
+  if (load < RESTORE_FRACTION * target_load_ && modes_ < max_modes_) {
+    modes_ += step_;
+    if (modes_ > max_modes_) {
+      modes_ = max_modes_;
+    }
+    hold_ = restore_hold_;
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,111 @@
+/*
+  LoadMeter.h
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+
+  CPU load of the audio callback, as a fraction of the block deadline
+  (block_size / sample_rate): 1.0 means the render took exactly as long as
+  the audio it produced, and anything more is an overrun, heard as a
+  glitch.  Time is read from the DWT cycle counter on the Daisy (Cortex-M7)
+  and from clock_gettime(CLOCK_MONOTONIC) on the host.
+
+  ModeGovernor uses the measured load to choose how many modes each string
+  renders, so that dense passages lose some high partials instead of
+  glitching.  It runs in the main loop, which is where string parameters
+  are changed (see StiffString.h), reading the statistics that the meter
+  updates in the audio callback.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+class LoadMeter {
+ public:
+  LoadMeter() {}
+
+  // Blocks of block_size samples at sample_rate.  Also starts the clock.
+  void Init(float sample_rate, size_t block_size);
+  // Clear the statistics
+  void Reset();
+
+  // Call around the code being measured, once per block
+  void BlockStart() { start_ = Now(); }
+  void BlockEnd();
+
+  // These may be read from another thread while the meter is running.
+  // load of the most recent block
+  float load() const { return load_.load(std::memory_order_relaxed); }
+  // load smoothed over about kAverageTime seconds
+  float average_load() const {
+    return average_load_.load(std::memory_order_relaxed);
+  }
+  // highest load since Reset()
+  float peak_load() const { return peak_load_.load(std::memory_order_relaxed); }
+  uint32_t num_blocks() const {
+    return num_blocks_.load(std::memory_order_relaxed);
+  }
+  // blocks that missed their deadline (load > 1)
+  uint32_t num_overruns() const {
+    return num_overruns_.load(std::memory_order_relaxed);
+  }
+  // Mean load since Reset().  Only valid between blocks (it is 64 bits,
+  // and so not atomic on the Daisy).
+  float mean_load() const;
+
+  float blocks_per_second() const { return blocks_per_second_; }
+
+  // time constant of average_load(), in seconds
+  static constexpr float kAverageTime = 0.05f;
+
+ private:
+  static uint32_t Now();
+  static float TicksPerSecond();
+
+  float blocks_per_second_ = 0.0f;
+  float inv_ticks_per_block_ = 0.0f;
+  float average_coeff_ = 0.0f;
+  uint32_t start_ = 0;
+
+  // written by BlockEnd() only
+  std::atomic<float> load_{0.0f};
+  std::atomic<float> average_load_{0.0f};
+  std::atomic<float> peak_load_{0.0f};
+  std::atomic<uint32_t> num_blocks_{0};
+  std::atomic<uint32_t> num_overruns_{0};
+  uint64_t total_ticks_ = 0;
+};
+
+// Chooses a mode count between min_modes and max_modes to keep the average
+// load below target_load.  Modes are shed quickly when the load is over the
+// target, and added back slowly once it is well below, so that the count
+// does not oscillate.
+class ModeGovernor {
+ public:
+  ModeGovernor() {}
+
+  void Init(float blocks_per_second, int min_modes, int max_modes,
+            float target_load);
+
+  // Call regularly (e.g. from the main loop) with a running meter.  Returns
+  // true if max_modes() has changed, and should be passed on (e.g. to
+  // StringSynth::set_max_modes).
+  bool Update(const LoadMeter &meter);
+
+  int max_modes() const { return modes_; }
+
+ private:
+  int min_modes_ = 0;
+  int max_modes_ = 0;
+  int modes_ = 0;
+  int step_ = 1;
+  float target_load_ = 1.0f;
+  int hold_ = 0;  // blocks to wait before the next change
+  uint32_t last_blocks_ = 0;  // meter readings at the last Update()
+  uint32_t last_overruns_ = 0;
+  int shed_hold_ = 0;
+  int restore_hold_ = 0;
+};
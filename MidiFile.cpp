@@ -0,0 +1,175 @@
+/*
+  MidiFile.cpp
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+*/
+
+#include "MidiFile.h"
+#include <stdio.h>
+#include <algorithm>
+
+namespace {
+
+// An event as read from a track, timed in ticks.  Tempo changes are kept
+// in the same list (with status 0) until times are converted to seconds.
+struct TrackEvent {
+  uint32_t tick;
+  uint32_t order;  // position in the file, to keep the sort stable
+  uint32_t tempo;  // microseconds per quarter note, for tempo changes
+  MidiFileEvent event;
+};
+
+class Reader {
+ public:
+  Reader(const uint8_t *data, size_t size) : p_(data), end_(data + size) {}
+  bool done() const { return p_ >= end_; }
+  bool Has(size_t n) const { return static_cast<size_t>(end_ - p_) >= n; }
+  uint8_t Byte() { return done() ? 0 : *p_++; }
+  uint8_t Peek() const { return done() ? 0 : *p_; }
+  uint32_t Big(int num_bytes) {
+    uint32_t value = 0;
+    for (int i = 0; i < num_bytes; ++i) {
+      value = (value << 8) | Byte();
+    }
+    return value;
+  }
+  uint32_t VarLen() {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+      uint8_t b = Byte();
+      value = (value << 7) | (b & 0x7f);
+      if (!(b & 0x80)) {
+        break;
+      }
+    }
+    return value;
+  }
+  void Skip(size_t n) { p_ = Has(n) ? p_ + n : end_; }
+  const uint8_t *pos() const { return p_; }
+
+ private:
+  const uint8_t *p_;
+  const uint8_t *end_;
+};
+
+bool ReadTrack(Reader track, uint32_t *order,
+               std::vector<TrackEvent> *events) {
+  uint32_t tick = 0;
+  uint8_t running_status = 0;
+  while (!track.done()) {
+    tick += track.VarLen();
+    uint8_t status = track.Peek();
+    if (status & 0x80) {
+      track.Byte();
+    } else if (running_status) {
+      status = running_status;
+    } else {
+      return false;
+    }
+    if (status == 0xff) {  // meta event
+      uint8_t type = track.Byte();
+      uint32_t length = track.VarLen();
+      if (type == 0x51 && length == 3) {  // set tempo
+        TrackEvent e = {tick, (*order)++, track.Big(3), {0.0, 0, 0, 0}};
+        events->push_back(e);
+      } else {
+        track.Skip(length);
+        if (type == 0x2f) {  // end of track
+          break;
+        }
+      }
+      continue;
+    }
+    if (status == 0xf0 || status == 0xf7) {  // sysex
+      track.Skip(track.VarLen());
+      continue;
+    }
+    running_status = status;
+    int type = status & 0xf0;
+    uint8_t data1 = track.Byte();
+    uint8_t data2 = (type == 0xc0 || type == 0xd0) ? 0 : track.Byte();
+    if (type == MIDI_NOTE_ON || type == MIDI_NOTE_OFF ||
+        type == MIDI_CONTROL_CHANGE) {
+      TrackEvent e = {tick, (*order)++, 0, {0.0, status, data1, data2}};
+      events->push_back(e);
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+bool MidiFile::Read(const char *path) {
+  events_.clear();
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    return false;
+  }
+  std::vector<uint8_t> data;
+  uint8_t buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+    data.insert(data.end(), buf, buf + n);
+  }
+  fclose(f);
+
+  Reader file(data.data(), data.size());
+  if (file.Big(4) != 0x4d546864) {  // "MThd"
+    return false;
+  }
+  uint32_t header_length = file.Big(4);
+  file.Big(2);  // format: 0 and 1 are read the same way
+  int num_tracks = file.Big(2);
+  uint16_t division = file.Big(2);
+  file.Skip(header_length - 6);
+
+  std::vector<TrackEvent> events;
+  uint32_t order = 0;
+  for (int i = 0; i < num_tracks && !file.done(); ++i) {
+    uint32_t id = file.Big(4);
+    uint32_t length = file.Big(4);
+    if (!file.Has(length)) {
+      return false;
+    }
+    if (id == 0x4d54726b) {  // "MTrk"
+      if (!ReadTrack(Reader(file.pos(), length), &order, &events)) {
+        return false;
+      }
+    }
+    file.Skip(length);
+  }
+  std::sort(events.begin(), events.end(),
+            [](const TrackEvent &a, const TrackEvent &b) {
+              return a.tick != b.tick ? a.tick < b.tick : a.order < b.order;
+            });
+
+  // convert ticks to seconds
+  double seconds_per_tick;
+  bool smpte = division & 0x8000;
+  if (smpte) {
+    int frames_per_second = 256 - (division >> 8);
+    seconds_per_tick = 1.0 / (frames_per_second * (division & 0xff));
+  } else {
+    seconds_per_tick = 0.5 / division;  // default tempo: 120 bpm
+  }
+  double time = 0.0;
+  uint32_t last_tick = 0;
+  for (const TrackEvent &e : events) {
+    time += (e.tick - last_tick) * seconds_per_tick;
+    last_tick = e.tick;
+    if (e.event.status == 0) {
+      if (!smpte) {
+        seconds_per_tick = e.tempo * 1.0e-6 / division;
+      }
+      continue;
+    }
+    events_.push_back(e.event);
+    events_.back().time = time;
+  }
+  return true;
+}
+
+double MidiFile::duration() const {
+  return events_.empty() ? 0.0 : events_.back().time;
+}
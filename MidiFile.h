@@ -0,0 +1,47 @@
+/*
+  MidiFile.h
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+
+  Reader for Standard MIDI Files (format 0 or 1), for the host tools.  The
+  tracks are merged into a single list of channel messages, time-stamped in
+  seconds using the file's tempo map.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+struct MidiFileEvent {
+  double time;     // seconds from the start of the file
+  uint8_t status;  // message type, with the channel in the low 4 bits
+  uint8_t data1;
+  uint8_t data2;
+
+  int type() const { return status & 0xf0; }
+  int channel() const { return status & 0x0f; }
+};
+
+// MIDI message types
+const int MIDI_NOTE_OFF = 0x80;
+const int MIDI_NOTE_ON = 0x90;
+const int MIDI_CONTROL_CHANGE = 0xb0;
+
+class MidiFile {
+ public:
+  MidiFile() {}
+  ~MidiFile() {}
+
+  // Read a file, replacing any events already loaded.  Returns false (with
+  // no events) if the file cannot be read or is not a valid MIDI file.
+  bool Read(const char *path);
+
+  const std::vector<MidiFileEvent> &events() const { return events_; }
+  // time of the last event, in seconds
+  double duration() const;
+
+ private:
+  std::vector<MidiFileEvent> events_;
+};
@@ -0,0 +1,78 @@
+/*
+  NoteTable.cpp
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+*/
+
+#include "NoteTable.h"
+#include "leaflet.h"
+
+NoteTable::~NoteTable() {
+  if (modes_ != nullptr) {
+    mpool_free(modes_, pool_);
+  }
+}
+
+size_t NoteTable::footprint() const {
+  return sizeof(*this) - sizeof(string_) + string_.footprint() +
+         (modes_ != nullptr ? kNumNotes * num_modes_ * sizeof(Mode) : 0);
+}
+
+bool NoteTable::Init(float sample_rate, int num_modes, tMempool *pool) {
+  num_up_to_date_ = 0;
+  if (modes_ != nullptr) {
+    mpool_free(modes_, pool_);
+  }
+  num_modes_ = 0;
+  pool_ = pool;
+  modes_ = static_cast<Mode *>(
+      mpool_alloc(kNumNotes * num_modes * sizeof(Mode), pool));
+  if (modes_ == nullptr || !string_.Init(sample_rate, num_modes, pool)) {
+    return false;
+  }
+  num_modes_ = num_modes;
+  string_.set_decay(decay_);
+  for (int note = 0; note < kNumNotes; ++note) {
+    freq_[note] = midi_to_freq(note);
+  }
+  return true;
+}
+
+bool NoteTable::Update(int max_notes) {
+  if (num_modes_ == 0) {
+    return false;
+  }
+  for (int n = 0; n < max_notes && num_up_to_date_ < kNumNotes; ++n) {
+    const int note = num_up_to_date_;
+    string_.set_freq(freq_[note]);
+    num_below_nyquist_[note] = string_.GetModes(modes_ + note * num_modes_);
+    ++num_up_to_date_;
+  }
+  return num_up_to_date_ == kNumNotes;
+}
+
+bool NoteTable::Tune(int note, StiffString *string) const {
+  if (note < 0 || note >= num_up_to_date_) {
+    return false;
+  }
+  string->SetModes(freq_[note], decay_, modes_ + note * num_modes_,
+                   num_below_nyquist_[note]);
+  return true;
+}
+
+void NoteTable::set_stiffness(float newValue) {
+  string_.set_stiffness(newValue);
+  num_up_to_date_ = 0;
+}
+
+void NoteTable::set_decay(float newValue) {
+  decay_ = newValue;
+  string_.set_decay(newValue);
+  num_up_to_date_ = 0;
+}
+
+void NoteTable::set_decay_high_freq(float newValue) {
+  string_.set_decay_high_freq(newValue);
+  num_up_to_date_ = 0;
+}
@@ -0,0 +1,82 @@
+/*
+  NoteTable.h
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+
+  The oscillator coefficients of a StiffString for each of the 128 MIDI
+  notes, under the current stiffness and decays.  Tuning a string takes a
+  pass over its modes with a sqrt, a sine and an exponential each, and a
+  note-on with set_freq() and set_decay() takes two; with the table, it
+  copies the note's coefficients instead (StiffString::SetModes()), in a
+  time that does not depend on the parameters.
+
+  A parameter change makes the whole table out of date.  Update() then
+  recomputes it a few notes at a time, to be called from the main loop
+  when there is nothing else to do, so a controller sweep never stalls the
+  loop.  Notes that are not up to date yet must be tuned the usual way:
+  Tune() says which.
+
+  The table is meant for the main loop alone, and its strings must have
+  the sample rate and number of modes of the table and, but for the decay,
+  the same parameters (see StiffString.h).
+*/
+
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include "StiffString.h"
+
+inline float midi_to_freq(float m) {
+  // Convert a MIDI note to frequency in Hz
+  return powf(2, (m - 69.0f) / 12.0f) * 440.0f;
+}
+
+class NoteTable {
+ public:
+  static const int kNumNotes = 128;
+  typedef DampedOscillatorBank::Mode Mode;
+
+  NoteTable() {}
+  ~NoteTable();
+  NoteTable(const NoteTable &) = delete;
+  NoteTable &operator=(const NoteTable &) = delete;
+
+  // Set up the table for strings of num_modes modes, with storage from
+  // pool.  Every note starts out of date.  Returns false (leaving every
+  // note out of date) if pool is out of memory.
+  bool Init(float sample_rate, int num_modes, tMempool *pool);
+  // pool memory needed by Init()
+  static constexpr size_t StorageBytes(int num_modes) {
+    return kNumNotes * num_modes * sizeof(Mode) +
+           StiffString::StorageBytes(num_modes);
+  }
+  // bytes used by the table: the object and its pool storage
+  size_t footprint() const;
+
+  // Recompute up to max_notes notes that are out of date.  Returns true if
+  // the whole table is then up to date.
+  bool Update(int max_notes = 1);
+  // Tune string to note with the table's parameters, if that note is up to
+  // date.  Returns false (leaving string alone) if not.
+  bool Tune(int note, StiffString *string) const;
+
+  // The parameters of the strings.  Changing one puts every note out of
+  // date.
+  void set_stiffness(float newValue);
+  void set_decay(float newValue);
+  void set_decay_high_freq(float newValue);
+
+ private:
+  // the first num_up_to_date_ notes are up to date
+  int num_up_to_date_ = 0;
+  int num_modes_ = 0;
+  float decay_ = 0.0f;
+  // the strings' coefficients are computed by this one's
+  StiffString string_;
+  tMempool *pool_ = nullptr;  // that modes_ came from
+  Mode *modes_ = nullptr;     // num_modes_ for each note
+  int num_below_nyquist_[kNumNotes];
+  float freq_[kNumNotes];
+};
@@ -0,0 +1,129 @@
+/*
+  Simd.h
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+
+  Minimal wrapper around the float vector types of the host instruction set,
+  so that kernels can be written once and compiled for AVX, SSE, NEON, or
+  plain scalar code.  VecF::kWidth is the number of float lanes.
+
+  Also ScopedFlushToZero, which keeps subnormal floats out of the
+  arithmetic while it is in scope.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define SIMD_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SIMD_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SIMD_NEON 1
+#endif
+
+#if SIMD_AVX
+struct VecF {
+  static const int kWidth = 8;
+  __m256 v;
+};
+inline VecF vload(const float *p) { return {_mm256_loadu_ps(p)}; }
+inline void vstore(float *p, VecF a) { _mm256_storeu_ps(p, a.v); }
+inline VecF vset1(float a) { return {_mm256_set1_ps(a)}; }
+inline VecF operator+(VecF a, VecF b) { return {_mm256_add_ps(a.v, b.v)}; }
+inline VecF operator-(VecF a, VecF b) { return {_mm256_sub_ps(a.v, b.v)}; }
+inline VecF operator*(VecF a, VecF b) { return {_mm256_mul_ps(a.v, b.v)}; }
+inline float vsum(VecF a) {
+  __m128 s = _mm_add_ps(_mm256_castps256_ps128(a.v),
+                        _mm256_extractf128_ps(a.v, 1));
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+  return _mm_cvtss_f32(s);
+}
+#elif SIMD_SSE
+struct VecF {
+  static const int kWidth = 4;
+  __m128 v;
+};
+inline VecF vload(const float *p) { return {_mm_loadu_ps(p)}; }
+inline void vstore(float *p, VecF a) { _mm_storeu_ps(p, a.v); }
+inline VecF vset1(float a) { return {_mm_set1_ps(a)}; }
+inline VecF operator+(VecF a, VecF b) { return {_mm_add_ps(a.v, b.v)}; }
+inline VecF operator-(VecF a, VecF b) { return {_mm_sub_ps(a.v, b.v)}; }
+inline VecF operator*(VecF a, VecF b) { return {_mm_mul_ps(a.v, b.v)}; }
+inline float vsum(VecF a) {
+  __m128 s = _mm_add_ps(a.v, _mm_movehl_ps(a.v, a.v));
+  s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+  return _mm_cvtss_f32(s);
+}
+#elif SIMD_NEON
+struct VecF {
+  static const int kWidth = 4;
+  float32x4_t v;
+};
+inline VecF vload(const float *p) { return {vld1q_f32(p)}; }
+inline void vstore(float *p, VecF a) { vst1q_f32(p, a.v); }
+inline VecF vset1(float a) { return {vdupq_n_f32(a)}; }
+inline VecF operator+(VecF a, VecF b) { return {vaddq_f32(a.v, b.v)}; }
+inline VecF operator-(VecF a, VecF b) { return {vsubq_f32(a.v, b.v)}; }
+inline VecF operator*(VecF a, VecF b) { return {vmulq_f32(a.v, b.v)}; }
+inline float vsum(VecF a) {
+  float32x2_t s = vadd_f32(vget_low_f32(a.v), vget_high_f32(a.v));
+  return vget_lane_f32(vpadd_f32(s, s), 0);
+}
+#else
+struct VecF {
+  static const int kWidth = 1;
+  float v;
+};
+inline VecF vload(const float *p) { return {*p}; }
+inline void vstore(float *p, VecF a) { *p = a.v; }
+inline VecF vset1(float a) { return {a}; }
+inline VecF operator+(VecF a, VecF b) { return {a.v + b.v}; }
+inline VecF operator-(VecF a, VecF b) { return {a.v - b.v}; }
+inline VecF operator*(VecF a, VecF b) { return {a.v * b.v}; }
+inline float vsum(VecF a) { return a.v; }
+#endif
+
+// alignment (in bytes) for arrays processed with VecF
+const int SIMD_ALIGN = 32;
+
+// Number of floats to reserve for an array of n, so that arrays carved one
+// after another from an aligned block all stay aligned
+constexpr int simd_padded(int n) {
+  return (n + SIMD_ALIGN / 4 - 1) / (SIMD_ALIGN / 4) * (SIMD_ALIGN / 4);
+}
+
+// Round p up to a multiple of SIMD_ALIGN
+inline char *simd_align(void *p) {
+  uintptr_t a = reinterpret_cast<uintptr_t>(p);
+  return reinterpret_cast<char *>((a + SIMD_ALIGN - 1) &
+                                  ~static_cast<uintptr_t>(SIMD_ALIGN - 1));
+}
+
+// Flush subnormal results and inputs to zero (the FTZ and DAZ bits of
+// MXCSR) in this thread while in scope, then restore the previous mode.
+// Decaying oscillators end up in subnormal numbers, which are very slow on
+// x86.  Elsewhere (the Cortex-M7 of the Daisy handles them at full speed)
+// this does nothing.
+class ScopedFlushToZero {
+ public:
+#if SIMD_AVX || SIMD_SSE
+  ScopedFlushToZero() : saved_(_mm_getcsr()) { _mm_setcsr(saved_ | 0x8040); }
+  ~ScopedFlushToZero() { _mm_setcsr(saved_); }
+#else
+  ScopedFlushToZero() {}
+#endif
+  ScopedFlushToZero(const ScopedFlushToZero &) = delete;
+  ScopedFlushToZero &operator=(const ScopedFlushToZero &) = delete;
+
+ private:
+#if SIMD_AVX || SIMD_SSE
+  unsigned int saved_;
+#endif
+};
@@ -0,0 +1,102 @@
+/*
+  SpectrumCache.cpp
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+*/
+
+#include "SpectrumCache.h"
+#include <math.h>
+#include <string.h>
+#include <cassert>
+
+// Mode n at position pos (as a fraction of half the string) goes as
+// sin(n x), as in StiffString.cpp
+inline float PhaseOf(float pos) { return pos * 0.5 * PI; }
+
+SpectrumCache::~SpectrumCache() {
+  if (storage_ != nullptr) {
+    mpool_free(storage_, pool_);
+  }
+}
+
+size_t SpectrumCache::footprint() const {
+  return sizeof(*this) + (num_modes_ > 0 ? StorageBytes(num_modes_) : 0);
+}
+
+float SpectrumCache::Position(int k) const {
+  return min_pos_ +
+         static_cast<float>(k) / (kNumPositions - 1) * (max_pos_ - min_pos_);
+}
+
+bool SpectrumCache::Init(int num_modes, float min_pos, float max_pos,
+                         tMempool *pool) {
+  assert(num_modes > 0 && max_pos > min_pos);
+  if (storage_ != nullptr) {
+    mpool_free(storage_, pool_);
+  }
+  num_modes_ = 0;
+  pool_ = pool;
+  storage_ = static_cast<char *>(mpool_alloc(StorageBytes(num_modes), pool));
+  if (storage_ == nullptr) {
+    return false;
+  }
+  stride_ = simd_padded(num_modes);
+  min_pos_ = min_pos;
+  max_pos_ = max_pos;
+  sin_ = reinterpret_cast<float *>(simd_align(storage_));
+  cos_ = sin_ + kNumPositions * stride_;
+  inv_n_sq_ = cos_ + kNumPositions * stride_;
+  for (int k = 0; k < kNumPositions; ++k) {
+    float x = PhaseOf(Position(k));
+    for (int i = 0; i < num_modes; ++i) {
+      sin_[k * stride_ + i] = sinf((i + 1) * x);
+      cos_[k * stride_ + i] = cosf((i + 1) * x);
+    }
+  }
+  for (int i = 0; i < num_modes; ++i) {
+    inv_n_sq_[i] = 1.0f / ((i + 1) * (i + 1));
+  }
+  num_modes_ = num_modes;
+  return true;
+}
+
+// Copy the nearest row if pos is on it, and otherwise rotate each mode from
+// there (see SpectrumCache.h)
+void SpectrumCache::Weights(float pos, float *out, int num_modes) const {
+  assert(num_modes <= num_modes_);
+  float t = (pos - min_pos_) * (kNumPositions - 1) / (max_pos_ - min_pos_);
+  int k = static_cast<int>(t + 0.5f);
+  if (k < 0) {
+    k = 0;
+  } else if (k > kNumPositions - 1) {
+    k = kNumPositions - 1;
+  }
+  const float *s = sin_ + k * stride_;
+  const float *c = cos_ + k * stride_;
+  float d = PhaseOf(pos) - PhaseOf(Position(k));
+  if (d == 0.0f) {
+    memcpy(out, s, num_modes * sizeof(float));
+    return;
+  }
+  const float cos_d = cosf(d);
+  const float sin_d = sinf(d);
+  float cos_nd = cos_d;
+  float sin_nd = sin_d;
+  for (int i = 0; i < num_modes; ++i) {
+    out[i] = s[i] * cos_nd + c[i] * sin_nd;
+    float next = cos_nd * cos_d - sin_nd * sin_d;
+    sin_nd = sin_nd * cos_d + cos_nd * sin_d;
+    cos_nd = next;
+  }
+}
+
+void SpectrumCache::Amplitudes(float pos, float *out, int num_modes) const {
+  pos = ClampPluckPos(pos);
+  Weights(pos, out, num_modes);
+  float x0 = PhaseOf(pos);
+  const float scale = 2.0f / (x0 * (PI - x0));
+  for (int i = 0; i < num_modes; ++i) {
+    out[i] *= scale * inv_n_sq_[i];
+  }
+}
@@ -0,0 +1,88 @@
+/*
+  SpectrumCache.h
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+
+  Precomputed mode profiles of a string, for the pluck and pickup positions
+  that a MIDI controller can reach.  A StiffString plucked at x has mode
+  amplitudes proportional to sin(n x) / n^2, and a pickup at x weights
+  mode n by sin(n x), so working either out takes a sinf (and, for the
+  amplitudes, a division) per mode.  The controllers only reach
+  kNumPositions positions, evenly spaced over [min_pos, max_pos] (as by
+  MidiScale() in StringSynth.cpp), so this keeps sin(n x) and cos(n x) for
+  each of them, and a string given the cache copies a row instead.
+
+  Positions in between (a pickup placed from two controllers, say) start
+  from the nearest row and rotate each mode by its offset, sin(n (x + d)) =
+  sin(n x) cos(n d) + cos(n x) sin(n d), with cos(n d) and sin(n d) worked
+  out by recurrence.  The recurrence adds rounding error of about one ulp
+  per mode, so mode n is off by about n ulp: small, unlike the error of
+  blending two rows, which fails for the high modes, whose phase changes
+  by several radians between rows.
+
+  The tables are allocated from a leaflet pool in Init() and only read
+  afterwards, so one cache can serve every string of a synth.
+*/
+
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include "Simd.h"
+#include "leaflet.h"
+
+// Closest a pluck comes to either end of the string, in the units of
+// StiffString::set_pluck_pos() (0 and 2 being the ends).  The amplitudes
+// of a pluck at phase x go as 1 / (x (pi - x)), which is infinite at the
+// ends, so plucks beyond this are taken at it.
+const float MIN_PLUCK_POS = 0.001f;
+inline float ClampPluckPos(float pos) {
+  return fminf(fmaxf(pos, MIN_PLUCK_POS), 2.0f - MIN_PLUCK_POS);
+}
+
+class SpectrumCache {
+ public:
+  static const int kNumPositions = 128;
+
+  SpectrumCache() {}
+  ~SpectrumCache();
+  SpectrumCache(const SpectrumCache &) = delete;
+  SpectrumCache &operator=(const SpectrumCache &) = delete;
+
+  // Fill in the tables for num_modes modes, at kNumPositions positions from
+  // min_pos to max_pos, with storage from pool.  Returns false (leaving the
+  // cache empty) if pool is out of memory.
+  bool Init(int num_modes, float min_pos, float max_pos, tMempool *pool);
+  // pool memory needed by Init()
+  static constexpr size_t StorageBytes(int num_modes) {
+    return (2 * kNumPositions + 1) * simd_padded(num_modes) * sizeof(float) +
+           SIMD_ALIGN;
+  }
+  // bytes used by the cache: the object and its pool storage
+  size_t footprint() const;
+
+  // modes in the tables (0 before a successful Init())
+  int num_modes() const { return num_modes_; }
+
+  // Set out[i] to the weight of mode i + 1 for a pickup at pos, for
+  // 0 <= i < num_modes (at most num_modes())
+  void Weights(float pos, float *out, int num_modes) const;
+  // Set out[i] to the amplitude of mode i + 1 for a pluck at pos (clamped
+  // by ClampPluckPos())
+  void Amplitudes(float pos, float *out, int num_modes) const;
+
+ private:
+  // position of row k
+  float Position(int k) const;
+
+  tMempool *pool_ = nullptr;  // that storage_ came from
+  char *storage_ = nullptr;
+  int num_modes_ = 0;
+  int stride_ = 0;  // floats per row
+  float min_pos_ = 0.0f;
+  float max_pos_ = 1.0f;
+  float *sin_ = nullptr;  // sin(n x) for each row, SIMD_ALIGN aligned
+  float *cos_ = nullptr;  // cos(n x) for each row
+  float *inv_n_sq_ = nullptr;  // 1 / n^2
+};
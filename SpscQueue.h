@@ -0,0 +1,72 @@
+/*
+  SpscQueue.h
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+
+  Wait-free queue for passing events from one producer (the main loop) to
+  one consumer (the audio callback), with no locks and without disabling
+  interrupts.  Each index is written by only one side: the producer advances
+  tail_ after writing an item, and the consumer advances head_ after reading
+  one, so an item is always complete before the other side can see it.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+template <class T, int kCapacity>
+class SpscQueue {
+  static_assert(kCapacity > 0 && (kCapacity & (kCapacity - 1)) == 0,
+                "capacity must be a power of two");
+
+ public:
+  SpscQueue() : head_(0), tail_(0) {}
+
+  // Producer: add an item.  Returns false if the queue is full.
+  bool Push(const T &item) {
+    const uint32_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == kCapacity) {
+      return false;
+    }
+    items_[tail & kMask] = item;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Producer: is there no room for another item?  Only the consumer can
+  // change the answer from true to false, so a false answer holds until the
+  // next Push().
+  bool full() const {
+    return tail_.load(std::memory_order_relaxed) -
+           head_.load(std::memory_order_acquire) == kCapacity;
+  }
+
+  // Consumer: remove the oldest item into *item.  Returns false if the
+  // queue is empty.
+  bool Pop(T *item) {
+    const uint32_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    *item = items_[head & kMask];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Empty the queue.  Not safe while the other side is using it.
+  void Clear() {
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+  }
+
+ private:
+  static const uint32_t kMask = kCapacity - 1;
+
+  T items_[kCapacity];
+  // Free-running counts of items pushed and popped; only their difference
+  // matters, so they may wrap.
+  std::atomic<uint32_t> head_;
+  std::atomic<uint32_t> tail_;
+};
@@ -13,66 +13,274 @@
 #include "StiffString.h"
 #include <math.h>
 #include <cassert>
+#include "Simd.h"
+#include "leaflet.h"  // also defines PI and TWO_PI
 
-const float PI = 4.0f * atanf(1.0f);
-const float TWO_PI = 2.0f * PI;
-
-StiffString::StiffString()
+template <class Bank, int kNumModes>
+BasicStiffString<Bank, kNumModes>::BasicStiffString()
     : num_modes_(0), sample_rate_(0.f) {}
 
-StiffString::StiffString(float sample_rate, int num_modes) {
-  Init(sample_rate, num_modes);
+template <class Bank, int kNumModes>
+BasicStiffString<Bank, kNumModes>::BasicStiffString(float sample_rate,
+                                                    int num_modes,
+                                                    tMempool *pool) {
+  Init(sample_rate, num_modes, pool);
 }
 
-StiffString::~StiffString() {}
+template <class Bank, int kNumModes>
+BasicStiffString<Bank, kNumModes>::~BasicStiffString() {
+  if (storage_ != nullptr) {
+    mpool_free(storage_, pool_);
+  }
+}
+
+template <class Bank, int kNumModes>
+size_t BasicStiffString<Bank, kNumModes>::footprint() const {
+  return sizeof(*this) +
+         (capacity_ > 0 ? StorageBytes(capacity_, max_pickups_) : 0);
+}
 
-void StiffString::Init(float sample_rate, int num_modes) {
+template <class Bank, int kNumModes>
+bool BasicStiffString<Bank, kNumModes>::Init(float sample_rate,
+                                             int num_modes, tMempool *pool,
+                                             int num_pickups) {
+  assert(num_modes > 0 && num_modes <= MAX_NUM_MODES);
+  assert(kNumModes == 0 || num_modes == kNumModes);
+  assert(num_pickups > 0 && num_pickups <= MAX_NUM_PICKUPS &&
+         num_pickups <= Bank::kMaxOutputs);
+  num_modes_ = 0;
+  num_modes_below_nyquist_ = 0;
+  num_active_modes_ = 0;
+  num_pickups_ = num_pickups;
+  if (num_modes > capacity_ || num_pickups > max_pickups_) {
+    if (storage_ != nullptr) {
+      mpool_free(storage_, pool_);
+    }
+    capacity_ = 0;
+    max_pickups_ = 0;
+    pool_ = pool;
+    size_t bytes = (1 + num_pickups) * simd_padded(num_modes) * sizeof(float) +
+                   SIMD_ALIGN;
+    storage_ = static_cast<char *>(mpool_alloc(bytes, pool));
+    if (storage_ == nullptr) {
+      return false;
+    }
+    amplitudes_ = reinterpret_cast<float *>(simd_align(storage_));
+    for (int k = 0; k < num_pickups; ++k) {
+      output_weights_[k] = amplitudes_ + (1 + k) * simd_padded(num_modes);
+    }
+    capacity_ = num_modes;
+    max_pickups_ = num_pickups;
+  }
+  if (!osc_.Init(num_modes, pool, num_pickups)) {
+    return false;
+  }
   num_modes_ = num_modes;
-  assert(num_modes <= MAX_NUM_MODES);
+  num_modes_below_nyquist_ = num_modes;
+  plucks_.store(0, std::memory_order_relaxed);
+  plucks_rendered_ = 0;
+  for (int i = 0; i < num_modes_; ++i) {
+    amplitudes_[i] = 0.0f;
+  }
   set_sample_rate(sample_rate);
-  UpdateOutputWeights();
+  for (int k = 0; k < num_pickups_; ++k) {
+    UpdateOutputWeights(k);
+  }
+  UpdateInputGains();
+  UpdateActiveModes();
+  return true;
 }
 
-void StiffString::set_sample_rate(float sample_rate) {
+template <class Bank, int kNumModes>
+void BasicStiffString<Bank, kNumModes>::set_sample_rate(float sample_rate) {
   sample_rate_ = sample_rate;
   two_pi_by_sample_rate_ = TWO_PI / sample_rate;
   assert(num_modes_ > 0 && num_modes_ <= MAX_NUM_MODES);
-  for (int i = 0; i < num_modes_; ++i) {
-    osc_[i].set_sample_rate(sample_rate);
-  }
+  osc_.set_sample_rate(sample_rate);
 }
 
-void StiffString::UpdateOscillators() {
+// Configure the oscillators for the current parameters.  Mode frequencies
+// increase with mode number, so we stop at the first mode above the cutoff
+// (nyquist_fraction_ times the Nyquist frequency); higher modes are culled.
+template <class Bank, int kNumModes>
+void BasicStiffString<Bank, kNumModes>::UpdateOscillators() {
+  if (!initialized()) {
+    return;
+  }
   float kappa_sq = stiffness_ * stiffness_;
-  for (int i = 0; i < num_modes_; ++i) {
-    int n = i + 1;
-    int n_sq = n * n;
-    float sig = decay_ + decay_high_freq_ * n_sq;
-    float w0 = n * sqrtf(1.0f + kappa_sq * n_sq);
-    // float w0 = n * (1.0f + 0.5f * kappa_sq * n_sq);
-    float zeta = sig / w0;
-    float w = w0 * sqrtf(1.0f - zeta * zeta);
-    // float w = w0 * (1.0f - 0.5f * zeta * zeta);
-    osc_[i].set_freq(freq_hz_ * w);
-    osc_[i].set_decay(freq_hz_ * sig);
+  float max_freq = nyquist_fraction_ * 0.5f * sample_rate_;
+  int i = 0;
+  if (fast_update_) {
+    // Same model as below, written as w = sqrt(w0^2 - sig^2) with
+    // w0^2 = n^2 (1 + kappa^2 n^2): one sqrt (a single instruction) and no
+    // division per mode, with n^2 updated by recurrence.  The oscillator
+    // coefficients are computed without libm calls; see
+    // DampedOscillatorBank::set_freq_and_decay.
+    float n_sq = 0.0f;
+    for (; i < num_modes(); ++i) {
+      n_sq += 2 * i + 1;
+      float sig = decay_ + decay_high_freq_ * n_sq;
+      float w_sq = n_sq * (1.0f + kappa_sq * n_sq) - sig * sig;
+      float freq = freq_hz_ * sqrtf(w_sq);
+      if (!(freq < max_freq)) {  // also catches NaN for overdamped modes
+        break;
+      }
+      osc_.set_freq_and_decay(i, freq, freq_hz_ * sig);
+    }
+  } else {
+    for (; i < num_modes(); ++i) {
+      int n = i + 1;
+      int n_sq = n * n;
+      float sig = decay_ + decay_high_freq_ * n_sq;
+      float w0 = n * sqrtf(1.0f + kappa_sq * n_sq);
+      // float w0 = n * (1.0f + 0.5f * kappa_sq * n_sq);
+      float zeta = sig / w0;
+      float w = w0 * sqrtf(1.0f - zeta * zeta);
+      // float w = w0 * (1.0f - 0.5f * zeta * zeta);
+      float freq = freq_hz_ * w;
+      if (!(freq < max_freq)) {
+        break;
+      }
+      osc_.set_freq(i, freq);
+      osc_.set_decay(i, freq_hz_ * sig);
+    }
+  }
+  num_modes_below_nyquist_ = i;
+  UpdateActiveModes();
+}
+
+// Set the number of modes to render: all modes below the cutoff frequency,
+// except for any trailing modes whose output gain is more than
+// cull_threshold_db_ below the loudest mode, and at most max_active_modes_.
+// Every parameter change ends here, so this also publishes the new
+// coefficients to the bank.  With several pickups, a mode's gain is its
+// largest over the pickups.
+template <class Bank, int kNumModes>
+float BasicStiffString<Bank, kNumModes>::ModeGain(int i) const {
+  float gain = 0.0f;
+  for (int k = 0; k < num_pickups_; ++k) {
+    gain = fmaxf(gain, fabsf(amplitudes_[i] * output_weights_[k][i]));
+  }
+  return gain;
+}
+
+template <class Bank, int kNumModes>
+void BasicStiffString<Bank, kNumModes>::UpdateActiveModes() {
+  float max_gain = 0.0f;
+  for (int i = 0; i < num_modes_below_nyquist_; ++i) {
+    max_gain = fmaxf(max_gain, ModeGain(i));
   }
+  float threshold = max_gain * powf(10.0f, 0.05f * cull_threshold_db_);
+  int n = num_modes_below_nyquist_;
+  if (n > max_active_modes_) {
+    n = max_active_modes_;
+  }
+  while (n > 0) {
+    if (ModeGain(n - 1) > threshold) {
+      break;
+    }
+    --n;
+  }
+  num_active_modes_ = n;
+  for (int k = 0; k < num_pickups_; ++k) {
+    for (int i = 0; i < n; ++i) {
+      osc_.set_gain(k, i, amplitudes_[i] * output_weights_[k][i]);
+    }
+  }
+  osc_.set_num_active(n);
+  osc_.Publish();
+}
+
+template <class Bank, int kNumModes>
+void BasicStiffString<Bank, kNumModes>::set_nyquist_fraction(float newValue) {
+  nyquist_fraction_ = newValue;
+  UpdateOscillators();
+}
+
+template <class Bank, int kNumModes>
+void BasicStiffString<Bank, kNumModes>::set_cull_threshold_db(float newValue) {
+  cull_threshold_db_ = newValue;
+  UpdateActiveModes();
+}
+
+template <class Bank, int kNumModes>
+void BasicStiffString<Bank, kNumModes>::set_max_active_modes(int newValue) {
+  max_active_modes_ = newValue;
+  UpdateActiveModes();
 }
 
-void StiffString::set_decay(float newValue) {
+template <class Bank, int kNumModes>
+void BasicStiffString<Bank, kNumModes>::set_decay(float newValue) {
   decay_ = newValue;
   UpdateOscillators();
 }
 
-void StiffString::set_decay_high_freq(float newValue) {
+template <class Bank, int kNumModes>
+void BasicStiffString<Bank, kNumModes>::set_decay_high_freq(float newValue) {
   decay_high_freq_ = newValue;
   UpdateOscillators();
 }
 
-void StiffString::set_freq(float freq_hz) {
+template <class Bank, int kNumModes>
+void BasicStiffString<Bank, kNumModes>::set_freq(float freq_hz) {
   freq_hz_ = freq_hz;
   UpdateOscillators();
 }
 
+template <class Bank, int kNumModes>
+int BasicStiffString<Bank, kNumModes>::GetModes(
+    typename Bank::Mode *modes) const {
+  for (int i = 0; i < num_modes_below_nyquist_; ++i) {
+    modes[i] = osc_.mode(i);
+  }
+  return num_modes_below_nyquist_;
+}
+
+template <class Bank, int kNumModes>
+void BasicStiffString<Bank, kNumModes>::SetModes(
+    float freq_hz, float decay, const typename Bank::Mode *modes,
+    int num_modes) {
+  if (!initialized()) {
+    return;
+  }
+  assert(num_modes <= this->num_modes());
+  freq_hz_ = freq_hz;
+  decay_ = decay;
+  for (int i = 0; i < num_modes; ++i) {
+    osc_.set_mode(i, modes[i]);
+  }
+  num_modes_below_nyquist_ = num_modes;
+  UpdateActiveModes();
+}
+
+// Render with the bank's kernel for kNumModes oscillators, or its general
+// one for kNumModes = 0
+template <int kNumModes>
+struct BankRenderer {
+  template <class Bank>
+  static void Process(Bank *bank, float *const *out, size_t size) {
+    bank->template ProcessStatic<kNumModes>(out, size);
+  }
+  template <class Bank>
+  static void Process(Bank *bank, const float *in, float *const *out,
+                      size_t size) {
+    bank->template ProcessStatic<kNumModes>(in, out, size);
+  }
+};
+
+template <>
+struct BankRenderer<0> {
+  template <class Bank>
+  static void Process(Bank *bank, float *const *out, size_t size) {
+    bank->Process(out, size);
+  }
+  template <class Bank>
+  static void Process(Bank *bank, const float *in, float *const *out,
+                      size_t size) {
+    bank->Process(in, out, size);
+  }
+};
+
 inline float clip(float val, float min = 0.0f, float max = 1.0f) {
   if (val < min) {
     return min;
@@ -82,32 +290,166 @@ inline float clip(float val, float min = 0.0f, float max = 1.0f) {
   return max;
 }
 
-float StiffString::Tick() {
-  float sample = 0.0f;
-  for (int i = 0; i < num_modes_; ++i) {
-    sample += osc_[i].Tick() * amplitudes_[i] * output_weights_[i];
+// Restart the oscillators if SetInitialAmplitudes() has been called since
+// the last block.  The acquire load makes the coefficients published before
+// the pluck visible here.
+template <class Bank, int kNumModes>
+void BasicStiffString<Bank, kNumModes>::PluckIfRequested() {
+  if (!deferred_plucks_) {
+    StartPluck(plucks_.load(std::memory_order_acquire));
   }
-  return sample;
 }
 
-void StiffString::set_pickup_pos(float newValue) {
-  pickup_pos_ = newValue;
-  UpdateOutputWeights();
+template <class Bank, int kNumModes>
+void BasicStiffString<Bank, kNumModes>::StartPluck(uint32_t plucks) {
+  if (plucks != plucks_rendered_) {
+    plucks_rendered_ = plucks;
+    osc_.Reset();
+  }
 }
 
-void StiffString::UpdateOutputWeights() {
-  float x0 = pickup_pos_ * 0.5 * PI;
-  for (int i = 0; i < num_modes_; ++i) {
-    output_weights_[i] = sinf((i + 1) * x0);
+template <class Bank, int kNumModes>
+float BasicStiffString<Bank, kNumModes>::Tick() {
+  float samples[MAX_NUM_PICKUPS] = {};
+  float *out[MAX_NUM_PICKUPS];
+  for (int k = 0; k < MAX_NUM_PICKUPS; ++k) {
+    out[k] = &samples[k];
   }
+  PluckIfRequested();
+  BankRenderer<kNumModes>::Process(&osc_, out, 1);
+  return samples[0];
 }
 
-void StiffString::SetInitialAmplitudes() {
-  float x0 = pluck_pos_ * 0.5 * PI;
-  for (int i = 0; i < num_modes_; ++i) {
-    int n = i + 1;
-    float denom = n * n * x0 * (PI - x0);
-    amplitudes_[i] = 2.0f * sinf(x0 * n) / denom;
-    osc_[i].Reset();
+// Render a block of samples.  Equivalent to calling Tick() size times, but
+// each oscillator's state stays in registers for the whole block, and all
+// the pickups are rendered in the same pass.
+template <class Bank, int kNumModes>
+void BasicStiffString<Bank, kNumModes>::Process(float *const *out,
+                                                size_t size) {
+  for (int k = 0; k < num_pickups_; ++k) {
+    for (size_t j = 0; j < size; ++j) {
+      out[k][j] = 0.0f;
+    }
+  }
+  PluckIfRequested();
+  BankRenderer<kNumModes>::Process(&osc_, out, size);
+}
+
+template <class Bank, int kNumModes>
+void BasicStiffString<Bank, kNumModes>::Process(float *out, size_t size) {
+  assert(num_pickups_ == 1);
+  Process(&out, size);
+}
+
+template <class Bank, int kNumModes>
+void BasicStiffString<Bank, kNumModes>::Process(const float *in,
+                                                float *const *out,
+                                                size_t size) {
+  for (int k = 0; k < num_pickups_; ++k) {
+    for (size_t j = 0; j < size; ++j) {
+      out[k][j] = 0.0f;
+    }
+  }
+  PluckIfRequested();
+  BankRenderer<kNumModes>::Process(&osc_, in, out, size);
+}
+
+template <class Bank, int kNumModes>
+void BasicStiffString<Bank, kNumModes>::Process(const float *in, float *out,
+                                                size_t size) {
+  assert(num_pickups_ == 1);
+  Process(in, &out, size);
+}
+
+template <class Bank, int kNumModes>
+void BasicStiffString<Bank, kNumModes>::set_input_gain(float newValue) {
+  input_gain_ = newValue;
+  UpdateInputGains();
+  UpdateActiveModes();
+}
+
+// The input gains are the same for every mode, the profile being in the
+// output gains with the pluck amplitudes (which is the same, by linearity).
+template <class Bank, int kNumModes>
+void BasicStiffString<Bank, kNumModes>::UpdateInputGains() {
+  if (!initialized()) {
+    return;
   }
+  for (int i = 0; i < num_modes(); ++i) {
+    osc_.set_input_gain(i, input_gain_);
+  }
+}
+
+template <class Bank, int kNumModes>
+void BasicStiffString<Bank, kNumModes>::set_pickup_pos(int pickup,
+                                                       float newValue) {
+  pickup_pos_[pickup] = newValue;
+  if (pickup < num_pickups_) {
+    UpdateOutputWeights(pickup);
+    UpdateActiveModes();
+  }
+}
+
+// The cache, if it has enough modes
+template <class Bank, int kNumModes>
+const SpectrumCache *BasicStiffString<Bank, kNumModes>::cache() const {
+  if (spectrum_cache_ != nullptr &&
+      spectrum_cache_->num_modes() >= num_modes()) {
+    return spectrum_cache_;
+  }
+  return nullptr;
+}
+
+template <class Bank, int kNumModes>
+void BasicStiffString<Bank, kNumModes>::UpdateOutputWeights(int pickup) {
+  if (!initialized()) {
+    return;
+  }
+  if (cache()) {
+    cache()->Weights(pickup_pos_[pickup], output_weights_[pickup],
+                     num_modes());
+    return;
+  }
+  float x0 = pickup_pos_[pickup] * 0.5 * PI;
+  for (int i = 0; i < num_modes(); ++i) {
+    output_weights_[pickup][i] = sinf((i + 1) * x0);
+  }
+}
+
+template <class Bank, int kNumModes>
+void BasicStiffString<Bank, kNumModes>::SetAmplitudes() {
+  if (!initialized()) {
+    return;
+  }
+  if (cache()) {
+    cache()->Amplitudes(pluck_pos_, amplitudes_, num_modes());
+  } else {
+    float x0 = ClampPluckPos(pluck_pos_) * 0.5 * PI;
+    for (int i = 0; i < num_modes(); ++i) {
+      int n = i + 1;
+      float denom = n * n * x0 * (PI - x0);
+      amplitudes_[i] = 2.0f * sinf(x0 * n) / denom;
+    }
+  }
+  UpdateActiveModes();
 }
+
+template <class Bank, int kNumModes>
+void BasicStiffString<Bank, kNumModes>::SetInitialAmplitudes() {
+  if (!initialized()) {
+    return;
+  }
+  SetAmplitudes();
+  plucks_.fetch_add(1, std::memory_order_release);
+}
+
+template class BasicStiffString<DampedOscillatorBank>;
+template class BasicStiffString<CycleBank>;
+template class BasicStiffString<FixedOscillatorBank>;
+template class BasicStiffString<BankSlice>;
+// Sizes of StaticStiffString.  Add others here and in
+// DampedOscillatorBank.cpp.
+template class BasicStiffString<DampedOscillatorBank, 16>;
+template class BasicStiffString<DampedOscillatorBank, 32>;
+template class BasicStiffString<DampedOscillatorBank, 60>;
+template class BasicStiffString<DampedOscillatorBank, 128>;
@@ -8,50 +8,225 @@
     Copyright 2023 Clarence W. Rowley
 
   ==============================================================================
+
+  Modal model of a plucked stiff string.  The modes are rendered by an
+  oscillator bank chosen at compile time: DampedOscillatorBank (waveguide
+  recurrences) for StiffString, CycleBank (wavetable phasors with
+  decaying envelopes) for CycleStiffString, FixedOscillatorBank (the
+  waveguide recurrences in fixed point) for FixedStiffString, or BankSlice
+  (part of a bank shared with other strings) for the strings of a
+  StringBank.  A bank provides Init(), StorageBytes(), Process() (with and
+  without an input), Reset(), set_freq(), set_decay(),
+  set_freq_and_decay(), set_gain(), set_input_gain(), set_num_active(),
+  Mode, mode(), set_mode(), Publish(), set_sample_rate(),
+  set_ramp_length() and kMaxOutputs, with the meanings in
+  DampedOscillatorBank.h.
+
+  Process() and Tick() may run in a different thread (the audio callback)
+  from everything else.  The other methods compute the mode coefficients
+  and publish them to the bank as a whole, so the renderer never sees a
+  half-updated set, and SetInitialAmplitudes() asks the renderer to pluck
+  the string with them at its next block (or, with deferred plucks, when
+  the renderer says so).
+
+  The per-mode arrays of the string and its bank are sized for num_modes
+  and allocated from a leaflet pool in Init(), so a string only takes the
+  memory it needs, from whichever region the pool covers.  Nothing is
+  allocated after Init().
+
+  A string may have up to MAX_NUM_PICKUPS pickups (for instance a stereo
+  pair), each with its own position and output.  They are rendered in one
+  pass over the modes, each mode's gain for each pickup (pluck amplitude
+  times pickup weight) being worked out whenever a parameter changes.
+
+  Besides being plucked, the string can be driven by an audio signal (from
+  a piezo, say), passed to Process() as a forced resonator.  Each mode's
+  response at its own frequency is input_gain times the input, weighted in
+  the output by the mode's amplitude (from the pluck position) and pickup
+  weights, like the response to a pluck; the response is the same for
+  every decay, only slower to build up for less damped modes.  The bank
+  renders the input as part of its pass over the modes.  SetAmplitudes()
+  sets the profile without plucking.  The input has no effect with
+  CycleBank.
+
+  The sinf per mode for the pluck and pickup positions can instead come
+  from a SpectrumCache shared by several strings (set_spectrum_cache()),
+  which copies precomputed values for the positions on its rows.  The rest
+  of the update (UpdateActiveModes() and Publish()) remains, so this saves
+  only about a fifth of a pluck or pickup move at 60 modes.
+
+  The number of modes may instead be fixed at compile time, with the
+  kNumModes template argument (StaticStiffString<N>).  The loops over modes
+  then have constant bounds, and the bank renders with a kernel laid out for
+  exactly that many (DampedOscillatorBank::ProcessStatic).  Such a string
+  must be Init()ed with kNumModes modes; until then, its setters do nothing.
 */
 
 #pragma once
 
-#include "DampedOscillator.h"
+#include <stdint.h>
+#include <atomic>
+#include "CycleBank.h"
+#include "DampedOscillatorBank.h"
+#include "BankSlice.h"
+#include "FixedOscillatorBank.h"
+#include "SpectrumCache.h"
 
-const int MAX_NUM_MODES = 400;
+const int MAX_NUM_MODES = 400;  // most modes per string
+const int MAX_NUM_PICKUPS = 4;  // most outputs per string
 
-class StiffString {
+template <class Bank, int kNumModes = 0>
+class BasicStiffString {
  public:
-  StiffString();
-  StiffString(float sample_rate, int num_modes);
-  ~StiffString();
+  BasicStiffString();
+  BasicStiffString(float sample_rate, int num_modes, tMempool *pool);
+  ~BasicStiffString();
+  BasicStiffString(const BasicStiffString &) = delete;
+  BasicStiffString &operator=(const BasicStiffString &) = delete;
 
-  void Init(float sample_rate, int num_modes);
+  // Set up num_modes modes and num_pickups pickups (at most
+  // Bank::kMaxOutputs), with storage from pool.  Storage is only
+  // reallocated if it grows.  Returns false (leaving the string silent) if
+  // pool is out of memory.
+  bool Init(float sample_rate, int num_modes, tMempool *pool,
+            int num_pickups = 1);
+  // pool memory needed by a string of num_modes modes and num_pickups
+  // pickups
+  static constexpr size_t StorageBytes(int num_modes, int num_pickups = 1) {
+    return (1 + num_pickups) * simd_padded(num_modes) * sizeof(float) +
+           SIMD_ALIGN + Bank::StorageBytes(num_modes, num_pickups);
+  }
+  // bytes used by this string: the object and its pool storage
+  size_t footprint() const;
+  // Pluck the string (at pluck_pos), from the start of the next block
   void SetInitialAmplitudes();
+  // Set the mode amplitudes for pluck_pos, as SetInitialAmplitudes() does,
+  // but without plucking: the profile of the response to the input
+  void SetAmplitudes();
+  // one sample of the first pickup
   float Tick();
+  // Render a block into out[k] for each pickup k
+  void Process(float *const *out, size_t size);
+  // Render a block of a string with one pickup
+  void Process(float *out, size_t size);
+  // Render a block, with the modes driven by in (see above)
+  void Process(const float *in, float *const *out, size_t size);
+  void Process(const float *in, float *out, size_t size);
+  // Copy the bank coefficients of the modes below the cutoff frequency to
+  // modes (room for num_modes()), and return how many there are
+  int GetModes(typename Bank::Mode *modes) const;
+  // Tune the string as set_freq(freq_hz) and set_decay(decay) would, but
+  // with the coefficients of its first num_modes modes copied from modes,
+  // which GetModes() filled in for a string with the same other parameters
+  // (see NoteTable.h).  Much faster, as it computes nothing per mode.
+  void SetModes(float freq_hz, float decay, const typename Bank::Mode *modes,
+                int num_modes);
+  // The part of Process() before rendering: start a pluck requested by
+  // SetInitialAmplitudes(), if any.  For a string whose bank is rendered
+  // elsewhere (see StringBank.h).
+  void PluckIfRequested();
+  // Plucks requested by SetInitialAmplitudes() since Init()
+  uint32_t num_plucks() const {
+    return plucks_.load(std::memory_order_relaxed);
+  }
+  // Start pluck number plucks (num_plucks() just after it was requested),
+  // unless it has already started.  For a renderer that defers plucks (see
+  // set_deferred_plucks()); the request must be visible to this thread.
+  void StartPluck(uint32_t plucks);
 
   // change parameters
   void set_sample_rate(float sr);
   void set_freq(float newFreqHz);
   void set_stiffness(float newValue) { stiffness_ = newValue; }
-  void set_pickup_pos(float newValue);
+  // position of the given pickup (or of the first)
+  void set_pickup_pos(int pickup, float newValue);
+  void set_pickup_pos(float newValue) { set_pickup_pos(0, newValue); }
+  // from 0 (one end) to 2 (the other); see ClampPluckPos()
   void set_pluck_pos(float newValue) { pluck_pos_ = newValue; }
   void set_decay(float newValue);
   void set_decay_high_freq(float newValue);
+  // modes above this fraction of the Nyquist frequency are not rendered
+  void set_nyquist_fraction(float newValue);
+  // trailing modes this far (in dB) below the loudest are not rendered
+  void set_cull_threshold_db(float newValue);
+  // Render at most this many modes (the lowest ones).  Modes above the
+  // limit stop at once, so lowering it mid-note is audible as a slight
+  // dulling rather than a glitch; see ModeGovernor in LoadMeter.h.
+  void set_max_active_modes(int newValue);
+  // use polynomial approximations instead of libm in UpdateOscillators()
+  void set_fast_update(bool newValue) { fast_update_ = newValue; }
+  // Leave plucks to StartPluck(), rather than starting each at the next
+  // block of Process(), so that the renderer can start one together with
+  // its own state for the note (see VoicePool.h).  Set before rendering.
+  void set_deferred_plucks(bool newValue) { deferred_plucks_ = newValue; }
+  // response of each mode to the input of Process() (0 = not driven)
+  void set_input_gain(float newValue);
+  // Take the pluck amplitudes and pickup weights from cache, if it covers
+  // num_modes() modes (nullptr to compute them here).  The cache must
+  // outlive the string.
+  void set_spectrum_cache(const SpectrumCache *cache) {
+    spectrum_cache_ = cache;
+  }
+  // Smooth parameter changes over this many samples (0 = change instantly).
+  // Changes arriving during a ramp are picked up when it ends.
+  void set_smoothing(int num_samples) { osc_.set_ramp_length(num_samples); }
+
+  int num_modes() const { return kNumModes > 0 ? kNumModes : num_modes_; }
+  int num_active_modes() const { return num_active_modes_; }
+  int num_pickups() const { return num_pickups_; }
+  float input_gain() const { return input_gain_; }
+  // the oscillators (for StringBank, which attaches them to its own bank)
+  Bank *bank() { return &osc_; }
 
  private:
+  // false until a successful Init() of a fixed-size string
+  bool initialized() const { return kNumModes == 0 || num_modes_ > 0; }
   void UpdateOscillators();
-  void UpdateOutputWeights();
+  const SpectrumCache *cache() const;
+  void UpdateOutputWeights(int pickup);
+  void UpdateInputGains();
+  float ModeGain(int i) const;
+  void UpdateActiveModes();
 
   int num_modes_;
+  int num_modes_below_nyquist_ = 0;
+  // SetInitialAmplitudes() counts plucks, and Process() handles each new one
+  std::atomic<uint32_t> plucks_{0};
+  uint32_t plucks_rendered_ = 0;
+  bool deferred_plucks_ = false;
+  int num_active_modes_ = 0;
   float sample_rate_;
   float two_pi_by_sample_rate_;
 
-  DampedOscillator osc_[MAX_NUM_MODES];
-  float amplitudes_[MAX_NUM_MODES];
-  float output_weights_[MAX_NUM_MODES];
-  float freq_hz_;
+  Bank osc_;
+  tMempool *pool_ = nullptr;  // that storage_ came from
+  char *storage_ = nullptr;
+  int capacity_ = 0;
+  int max_pickups_ = 0;  // that storage_ has room for
+  int num_pickups_ = 0;
+  float *amplitudes_ = nullptr;  // SIMD_ALIGN aligned
+  float *output_weights_[MAX_NUM_PICKUPS] = {};  // one array per pickup
+  const SpectrumCache *spectrum_cache_ = nullptr;
+  float freq_hz_ = 0.0f;
 
   // parameters
   float stiffness_ = 0.001f;
   float pluck_pos_ = 0.2f;
-  float pickup_pos_ = 0.3f;
+  float pickup_pos_[MAX_NUM_PICKUPS] = {0.3f, 0.3f, 0.3f, 0.3f};
   float decay_ = 0.0001f;
   float decay_high_freq_ = 0.0003f;
+  float nyquist_fraction_ = 1.0f;
+  float cull_threshold_db_ = -100.0f;
+  float input_gain_ = 0.0f;
+  int max_active_modes_ = MAX_NUM_MODES;
+  bool fast_update_ = true;
 };
+
+// Member definitions are in StiffString.cpp, which instantiates these.
+typedef BasicStiffString<DampedOscillatorBank> StiffString;
+typedef BasicStiffString<CycleBank> CycleStiffString;
+typedef BasicStiffString<FixedOscillatorBank> FixedStiffString;
+typedef BasicStiffString<BankSlice> BankString;
+// N = 16, 32, 60 or 128
+template <int N>
+using StaticStiffString = BasicStiffString<DampedOscillatorBank, N>;
@@ -0,0 +1,143 @@
+/*
+  StringBank.cpp
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+*/
+
+#include "StringBank.h"
+#include <math.h>
+#include <cassert>
+#include "leaflet.h"  // also defines PI
+
+StringBank::~StringBank() {
+  if (storage_ != nullptr) {
+    mpool_free(storage_, pool_);
+  }
+}
+
+size_t StringBank::footprint() const {
+  size_t bytes = sizeof(*this) +
+                 DampedOscillatorBank::StorageBytes(bank_.capacity(),
+                                                    bank_.num_outputs());
+  if (capacity_ > 0) {
+    bytes += simd_padded(capacity_) * sizeof(float) + SIMD_ALIGN;
+  }
+  for (int s = 0; s < num_strings_; ++s) {
+    bytes += strings_[s].footprint() - sizeof(BankString);
+  }
+  return bytes;
+}
+
+bool StringBank::Init(float sample_rate, int num_strings, int num_modes,
+                      tMempool *pool, int num_pickups) {
+  assert(num_strings > 0 && num_strings <= MAX_NUM_STRINGS);
+  assert(num_pickups > 0 && num_pickups <= BankSlice::kMaxOutputs);
+  num_strings_ = 0;
+  if (num_modes > capacity_) {
+    if (storage_ != nullptr) {
+      mpool_free(storage_, pool_);
+    }
+    capacity_ = 0;
+    pool_ = pool;
+    size_t bytes = simd_padded(num_modes) * sizeof(float) + SIMD_ALIGN;
+    storage_ = static_cast<char *>(mpool_alloc(bytes, pool));
+    if (storage_ == nullptr) {
+      return false;
+    }
+    bridge_weights_ = reinterpret_cast<float *>(simd_align(storage_));
+    capacity_ = num_modes;
+  }
+  if (!bank_.Init(num_strings * num_modes, pool, num_pickups + 1)) {
+    return false;
+  }
+  num_strings_ = num_strings;
+  num_modes_ = num_modes;
+  num_pickups_ = num_pickups;
+  UpdateCoupling();
+  bank_.set_num_active(num_strings * num_modes);
+  bank_.Publish();
+  bool ok = true;
+  for (int s = 0; s < num_strings_; ++s) {
+    strings_[s].bank()->Attach(this, s * num_modes);
+    ok = strings_[s].Init(sample_rate, num_modes, pool, num_pickups) && ok;
+  }
+  for (size_t j = 0; j < kBridgeDelay; ++j) {
+    bridge_[j] = 0.0f;
+  }
+  bridge_index_ = 0;
+  return ok;
+}
+
+void StringBank::set_coupling(float newValue) {
+  coupling_ = fminf(fmaxf(newValue, 0.0f), kMaxCoupling);
+  UpdateCoupling();
+}
+
+void StringBank::set_bridge_pos(float newValue) {
+  bridge_pos_ = newValue;
+  UpdateCoupling();
+}
+
+// Recompute the bridge weights, as for a pickup, and pass them to every
+// string
+void StringBank::UpdateCoupling() {
+  if (num_strings_ == 0) {
+    return;
+  }
+  float x0 = bridge_pos_ * 0.5 * PI;
+  for (int i = 0; i < num_modes_; ++i) {
+    bridge_weights_[i] = sinf((i + 1) * x0);
+  }
+  for (int s = 0; s < num_strings_; ++s) {
+    SetCouplingGains(s * num_modes_, num_modes_,
+                     strings_[s].num_active_modes());
+  }
+  bank_.Publish();
+}
+
+void StringBank::SetCouplingGains(int offset, int num_modes, int num_active) {
+  const float input_scale = coupling_ / num_strings_;
+  for (int i = 0; i < num_modes; ++i) {
+    float weight = i < num_active ? bridge_weights_[i] : 0.0f;
+    bank_.set_gain(num_pickups_, offset + i, weight);
+    bank_.set_input_gain(offset + i, input_scale * weight);
+  }
+}
+
+void StringBank::Process(float *const *out, size_t size) {
+  for (int k = 0; k < num_pickups_; ++k) {
+    for (size_t j = 0; j < size; ++j) {
+      out[k][j] = 0.0f;
+    }
+  }
+  if (num_strings_ == 0) {
+    return;
+  }
+  for (int s = 0; s < num_strings_; ++s) {
+    strings_[s].PluckIfRequested();
+  }
+  float *chunk_out[DampedOscillatorBank::kMaxOutputs];
+  chunk_out[num_pickups_] = chunk_bridge_;
+  // Chunks end where the delay line wraps around, so each one takes its
+  // input from, and writes its bridge signal back to, one stretch of it
+  size_t n;
+  for (size_t start = 0; start < size; start += n) {
+    n = kBridgeDelay - bridge_index_;
+    if (n > size - start) {
+      n = size - start;
+    }
+    for (int k = 0; k < num_pickups_; ++k) {
+      chunk_out[k] = out[k] + start;
+    }
+    for (size_t j = 0; j < n; ++j) {
+      chunk_bridge_[j] = 0.0f;
+    }
+    float *delayed = bridge_ + bridge_index_;
+    bank_.Process(delayed, chunk_out, n);
+    for (size_t j = 0; j < n; ++j) {
+      delayed[j] = chunk_bridge_[j];
+    }
+    bridge_index_ = (bridge_index_ + n) % kBridgeDelay;
+  }
+}
@@ -0,0 +1,118 @@
+/*
+  StringBank.h
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+
+  A set of strings (such as the six or twelve of a guitar) coupled through
+  a common bridge, so that a plucked string excites the sympathetic modes
+  of the others.  The modes of all the strings live in one
+  DampedOscillatorBank, string s having oscillators s * num_modes to
+  (s + 1) * num_modes - 1, and the whole bank, coupling included, is
+  rendered in one pass per block rather than string by string.  Each
+  string is a BasicStiffString (BankString, whose BankSlice passes its
+  coefficients through to its range of the shared bank), tuned, plucked
+  and set up in the usual way through string(s), but rendered only by
+  StringBank::Process().
+
+  The bridge is an extra output of the shared bank: a pickup at bridge_pos
+  on every string.  Its signal drives every mode, through the input of the
+  bank, with the same weights (the force a mode exerts on the bridge is
+  also how strongly the bridge moves it).  A mode's input gain is coupling
+  divided by the number of strings, which makes its steady response to a
+  bridge signal at its frequency independent of its decay (see
+  DampedOscillatorBank.h), and keeps the loop stable for coupling below 1,
+  even with every string in unison.  The bridge signal reaches the strings
+  through a delay line of kBridgeDelay samples, so that the bank can render
+  a chunk of up to that many samples at a time; the delay is the same
+  whatever the block size, and so is the output.
+
+  Process() may run in a different thread from everything else, as for
+  StiffString.  The coupling setters publish the shared bank's coefficients
+  in the same way as the strings' own setters.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include "DampedOscillatorBank.h"
+#include "StiffString.h"
+
+const int MAX_NUM_STRINGS = 12;
+
+class StringBank {
+ public:
+  StringBank() {}
+  ~StringBank();
+  StringBank(const StringBank &) = delete;
+  StringBank &operator=(const StringBank &) = delete;
+
+  // Set up num_strings strings of num_modes modes, each with num_pickups
+  // pickups (at most BankSlice::kMaxOutputs), with storage from pool.
+  // Returns false (leaving the bank silent) if pool is out of memory.
+  bool Init(float sample_rate, int num_strings, int num_modes,
+            tMempool *pool, int num_pickups = 1);
+  // pool memory needed by Init()
+  static constexpr size_t StorageBytes(int num_strings, int num_modes,
+                                       int num_pickups = 1) {
+    return num_strings * BankString::StorageBytes(num_modes, num_pickups) +
+           simd_padded(num_modes) * sizeof(float) + SIMD_ALIGN +
+           DampedOscillatorBank::StorageBytes(num_strings * num_modes,
+                                              num_pickups + 1);
+  }
+  // bytes used by the bank, its strings and their pool storage
+  size_t footprint() const;
+
+  // String s, to tune, pluck and set up as any StiffString.  Its Process()
+  // and Tick() render nothing.
+  BankString &string(int s) { return strings_[s]; }
+  int num_strings() const { return num_strings_; }
+
+  // Render a block of samples from all the strings, into out[k] for each
+  // pickup k, or into out for strings with one pickup.
+  void Process(float *const *out, size_t size);
+  void Process(float *out, size_t size) { Process(&out, size); }
+
+  // Amount of sympathetic coupling, from 0 (none) up to kMaxCoupling
+  void set_coupling(float newValue);
+  // Where the bridge signal is taken from each string, in the units of
+  // StiffString::set_pickup_pos().  Further from the end couples the low
+  // modes more strongly.
+  void set_bridge_pos(float newValue);
+  static constexpr float kMaxCoupling = 0.95f;
+
+  // For BankSlice: the shared bank, and setting the bridge and input gains
+  // of oscillators offset <= i < offset + num_modes, for num_active of
+  // them active, in the back buffer
+  DampedOscillatorBank *bank() { return &bank_; }
+  void SetCouplingGains(int offset, int num_modes, int num_active);
+
+ private:
+  // Delay of the coupling through the bridge, and so the longest chunk
+  // rendered at once
+  static const size_t kBridgeDelay = 64;
+
+  void UpdateCoupling();
+
+  BankString strings_[MAX_NUM_STRINGS];
+  int num_strings_ = 0;
+  int num_modes_ = 0;
+  int num_pickups_ = 0;
+  DampedOscillatorBank bank_;
+  tMempool *pool_ = nullptr;  // that storage_ came from
+  char *storage_ = nullptr;
+  int capacity_ = 0;  // modes that bridge_weights_ has room for
+  float *bridge_weights_ = nullptr;
+
+  // rendering side: the bridge signal of the last kBridgeDelay samples, in
+  // a circular buffer whose next sample is bridge_[bridge_index_] (the one
+  // to drive the strings now, and then to replace), and the bridge signal
+  // of the chunk being rendered
+  float bridge_[kBridgeDelay];
+  size_t bridge_index_ = 0;
+  float chunk_bridge_[kBridgeDelay];
+
+  // parameters
+  float coupling_ = 0.3f;
+  float bridge_pos_ = 0.3f;
+};
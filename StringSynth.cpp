@@ -0,0 +1,168 @@
+/*
+  StringSynth.cpp
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+*/
+
+#include "StringSynth.h"
+#include <math.h>
+#include "Simd.h"
+
+const float NOTE_OFF_DECAY = 0.01;
+const int SMOOTHING_SAMPLES = 48;  // ramp length for parameter changes
+const float MIN_POSITION = 0.001f;  // of the pluck and pickups
+
+inline float MidiScale(int midi_value, float min, float max) {
+  // Scale a MIDI parameter value (between 0 and 127) to the range [min, max]
+  return min + static_cast<float>(midi_value) / 127.0f * (max - min);
+}
+
+StringSynth::StringSynth(float sample_rate, int num_voices, int num_modes,
+                         tMempool *pool) {
+  Init(sample_rate, num_voices, num_modes, pool);
+}
+
+StringSynth::~StringSynth() {}
+
+bool StringSynth::Init(float sample_rate, int num_voices, int num_modes,
+                       tMempool *pool) {
+  sample_rate_ = sample_rate;
+  num_modes_ = num_modes;
+  bool ok = voices_.Init(sample_rate, num_voices, num_modes, pool,
+                         kNumChannels);
+  voices_.ForEachVoice([](StiffString &s) {
+    s.set_smoothing(SMOOTHING_SAMPLES);
+  });
+  UpdatePickups();
+  return ok;
+}
+
+bool StringSynth::InitSpectrumCache(tMempool *pool) {
+  // the positions that CC 2 and CC 5 reach
+  if (!spectrum_cache_.Init(num_modes_, MIN_POSITION, 1.0f, pool)) {
+    return false;
+  }
+  const SpectrumCache *cache = &spectrum_cache_;
+  voices_.ForEachVoice([=](StiffString &s) { s.set_spectrum_cache(cache); });
+  return true;
+}
+
+// The table takes the strings' parameters from the controllers from now on
+// (the others being the defaults of StiffString)
+bool StringSynth::InitNoteTable(tMempool *pool) {
+  if (!note_table_.Init(sample_rate_, num_modes_, pool)) {
+    return false;
+  }
+  note_table_.set_decay(decay_);
+  return true;
+}
+
+// Place the left and right pickups either side of pickup_center_, keeping
+// both on the string
+void StringSynth::UpdatePickups() {
+  float left = fmaxf(pickup_center_ - 0.5f * pickup_width_, MIN_POSITION);
+  float right = fminf(pickup_center_ + 0.5f * pickup_width_, 1.0f);
+  voices_.ForEachVoice([=](StiffString &s) {
+    s.set_pickup_pos(0, left);
+    s.set_pickup_pos(1, right);
+  });
+}
+
+void StringSynth::NoteOn(int note, int velocity) {
+  if (velocity == 0) {
+    NoteOff(note);
+    return;
+  }
+  const bool pluck = input_level_ == 0.0f;
+  const NoteTable *table = &note_table_;
+  voices_.NoteOn(note, MidiScale(velocity, 0.0f, 1.0f), [=](StiffString &s) {
+    if (!table->Tune(note, &s)) {
+      s.set_freq(midi_to_freq(note));
+      s.set_decay(decay_);
+    }
+    if (pluck) {
+      s.SetInitialAmplitudes();
+    } else {
+      s.SetAmplitudes();
+    }
+  });
+}
+
+void StringSynth::NoteOff(int note) {
+  StiffString *string = voices_.NoteOff(note);
+  if (string) {
+    string->set_decay(NOTE_OFF_DECAY);
+  }
+}
+
+void StringSynth::ControlChange(int control_number, int value) {
+  switch (control_number) {
+    case 1: {
+      float stiffness = MidiScale(value, 0.0f, 0.2f);
+      voices_.ForEachVoice([=](StiffString &s) {
+        s.set_stiffness(stiffness);
+      });
+      note_table_.set_stiffness(stiffness);
+    }
+      break;
+    case 2: {
+      float pluck_pos = MidiScale(value, MIN_POSITION, 1.0f);
+      voices_.ForEachVoice([=](StiffString &s) {
+        s.set_pluck_pos(pluck_pos);
+      });
+    }
+      break;
+    case 3: {
+      decay_high_freq_ = MidiScale(value, 0.0f, 0.0005f);
+      float decay_high_freq = decay_high_freq_;
+      voices_.ForEachVoice([=](StiffString &s) {
+        s.set_decay_high_freq(decay_high_freq);
+      });
+      note_table_.set_decay_high_freq(decay_high_freq);
+    }
+      break;
+    case 4: {
+      // released voices keep their NoteOff decay
+      decay_ = MidiScale(value, 0.0f, 0.005f);
+      float decay = decay_;
+      voices_.ForEachHeldVoice([=](StiffString &s) {
+        s.set_decay(decay);
+      });
+      note_table_.set_decay(decay);
+    }
+      break;
+    case 5:
+      pickup_center_ = MidiScale(value, MIN_POSITION, 1.0f);
+      UpdatePickups();
+      break;
+    case 6:
+      pickup_width_ = MidiScale(value, 0.0f, 0.5f);
+      UpdatePickups();
+      break;
+    case 7: {
+      input_level_ = MidiScale(value, 0.0f, 1.0f);
+      float input_level = input_level_;
+      voices_.ForEachVoice([=](StiffString &s) {
+        s.set_input_gain(input_level);
+      });
+      use_input_.store(input_level_ > 0.0f, std::memory_order_relaxed);
+    }
+      break;
+    default: break;
+  }
+}
+
+void StringSynth::set_max_modes(int newValue) {
+  voices_.ForEachVoice([=](StiffString &s) {
+    s.set_max_active_modes(newValue);
+  });
+}
+
+void StringSynth::Process(const float *in, float *left, float *right,
+                          size_t size) {
+  ScopedFlushToZero flush_to_zero;  // see Simd.h
+  float *const out[kNumChannels] = {left, right};
+  const bool use_input = use_input_.load(std::memory_order_relaxed);
+  voices_.Process(use_input ? in : nullptr, out, size);
+}
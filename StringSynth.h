@@ -0,0 +1,125 @@
+/*
+  StringSynth.h
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+
+  The instrument: a pool of StiffString voices, played through MIDI-style
+  note and controller messages.  This holds the mapping from MIDI values to
+  string parameters, so that the firmware (main.cpp) and the host tools
+  play identically.
+
+  Process() runs in the audio callback, and everything else in the main
+  loop; the two sides share no locks (see VoicePool.h and StiffString.h).
+
+  The strings can also be driven by an audio input (a piezo or drum pad,
+  say), as resonators tuned by the notes being held.  With an input level
+  above zero, a note tunes its voice without plucking it.
+
+  A SpectrumCache of pluck and pickup profiles for the positions the
+  controllers reach, if set up with InitSpectrumCache(), is shared by the
+  voices, so that a note or a pickup move copies them rather than
+  evaluating a sinf per mode.
+
+  A NoteTable of the strings' coefficients for every note, if set up with
+  InitNoteTable(), makes a note-on a copy of its note's coefficients rather
+  than two passes of computation over the modes.  The main loop calls
+  UpdateNoteTable() when idle to bring it up to date after a controller
+  change; until then, notes are tuned the usual way.
+
+  Each string has two pickups, for the left and right channels, placed
+  either side of a center position.  With zero width (the default) both
+  channels are the same.
+
+  Controllers:
+    CC 1  stiffness
+    CC 2  pluck position
+    CC 3  high-frequency decay
+    CC 4  decay
+    CC 5  pickup position (center of the pair)
+    CC 6  pickup width (distance between the left and right pickups)
+    CC 7  input level (0 for none)
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <atomic>
+#include "NoteTable.h"
+#include "VoicePool.h"
+
+class StringSynth {
+ public:
+  StringSynth() {}
+  StringSynth(float sample_rate, int num_voices, int num_modes,
+              tMempool *pool);
+  ~StringSynth();
+
+  // Set up the voices, with their storage from pool (see VoicePool::Init)
+  bool Init(float sample_rate, int num_voices, int num_modes, tMempool *pool);
+  // pool memory needed by Init()
+  static constexpr size_t StorageBytes(int num_voices, int num_modes) {
+    return VoicePool::StorageBytes(num_voices, num_modes, kNumChannels);
+  }
+  // bytes used by the voices and the spectrum cache
+  size_t footprint() const {
+    return voices_.footprint() + spectrum_cache_.footprint();
+  }
+
+  // Set up the spectrum cache, with storage from pool (which, like the note
+  // table's, only the main loop reads).  After Init().  Returns false,
+  // leaving the voices to compute their profiles, if pool is out of memory.
+  bool InitSpectrumCache(tMempool *pool);
+  // pool memory needed by InitSpectrumCache()
+  static constexpr size_t SpectrumCacheBytes(int num_modes) {
+    return SpectrumCache::StorageBytes(num_modes);
+  }
+
+  // Set up the note table, with storage from pool (which only the main loop
+  // reads, so it may be slower memory).  After Init().  Returns false,
+  // leaving the synth without a table, if pool is out of memory.
+  bool InitNoteTable(tMempool *pool);
+  // pool memory needed by InitNoteTable()
+  static constexpr size_t NoteTableBytes(int num_modes) {
+    return NoteTable::StorageBytes(num_modes);
+  }
+  // Recompute a note of the table, if any is out of date.  For the main
+  // loop, between messages.
+  void UpdateNoteTable() { note_table_.Update(); }
+
+  // MIDI messages (note, velocity and values between 0 and 127).  A NoteOn
+  // with velocity 0 is a NoteOff.
+  void NoteOn(int note, int velocity);
+  void NoteOff(int note);
+  void ControlChange(int control_number, int value);
+
+  // Render a block of samples.  Both channels come from one pass over each
+  // voice's modes.
+  void Process(float *left, float *right, size_t size) {
+    Process(nullptr, left, right, size);
+  }
+  // Process(), with the strings driven by in (if not nullptr)
+  void Process(const float *in, float *left, float *right, size_t size);
+
+  // Render at most this many modes per voice (for the CPU load governor)
+  void set_max_modes(int newValue);
+
+  VoicePool &voices() { return voices_; }
+
+ private:
+  static const int kNumChannels = 2;  // pickups per string: left and right
+
+  void UpdatePickups();
+
+  VoicePool voices_;
+  SpectrumCache spectrum_cache_;
+  NoteTable note_table_;
+  float sample_rate_ = 0.0f;
+  int num_modes_ = 0;
+  float decay_ = 0.0f;
+  float decay_high_freq_ = 0.0f;
+  float pickup_center_ = 0.3f;
+  float pickup_width_ = 0.0f;
+  float input_level_ = 0.0f;
+  std::atomic<bool> use_input_{false};  // input_level_ > 0, for Process()
+};
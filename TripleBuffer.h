@@ -0,0 +1,67 @@
+/*
+  TripleBuffer.h
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+
+  Slot bookkeeping for handing a set of values (such as per-mode
+  coefficients) from one writer thread to one reader thread.  The caller
+  keeps three copies of the data, indexed by slot.  The writer fills the
+  back slot and publishes it; the reader picks up the latest published slot
+  whenever it is ready.  Neither side ever waits.  This is double buffering
+  with a spare: the third slot lets the writer publish again before the
+  reader has taken the last one, in which case the reader skips to the
+  newest.
+*/
+
+#pragma once
+
+#include <atomic>
+
+class TripleBuffer {
+ public:
+  TripleBuffer() { Reset(); }
+
+  // Writer: the slot to fill
+  int back() const { return back_; }
+  // Writer: hand the back slot to the reader.  Returns the previous back
+  // slot, whose contents stay valid (and unchanged) until the next
+  // Publish(), so the writer can copy them to the new back slot.
+  int Publish() {
+    const int published = back_;
+    back_ = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel) &
+            kSlotMask;
+    return published;
+  }
+
+  // Reader: the slot to read
+  int front() const { return front_; }
+  // Reader: is there a newer slot than front()?
+  bool fresh() const {
+    return middle_.load(std::memory_order_relaxed) & kFresh;
+  }
+  // Reader: switch to the newest published slot.  Returns false (and
+  // leaves front() alone) if nothing has been published since last time.
+  bool Acquire() {
+    if (!fresh()) {
+      return false;
+    }
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kSlotMask;
+    return true;
+  }
+
+  // Back to the initial state.  Not safe while the other side is using it.
+  void Reset() {
+    back_ = 0;
+    middle_.store(1, std::memory_order_relaxed);
+    front_ = 2;
+  }
+
+ private:
+  static const int kSlotMask = 3;
+  static const int kFresh = 4;  // set in middle_ when it was just published
+
+  int back_;                 // owned by the writer
+  std::atomic<int> middle_;  // slot in transit, plus kFresh
+  int front_;                // owned by the reader
+};
@@ -0,0 +1,216 @@
+/*
+  VoicePool.cpp
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+*/
+
+#include "VoicePool.h"
+#include <math.h>
+#include <cassert>
+
+// Longest block rendered per voice at once; longer blocks are split.
+const size_t MAX_CHUNK = 64;
+
+VoicePool::VoicePool()
+    : num_voices_(0), num_outputs_(1), note_count_(0),
+      steal_policy_(STEAL_OLDEST), silence_threshold_(1.0e-4f),
+      silence_hold_(0.05f), silence_hold_samples_(0), sample_rate_(0.0f) {}
+
+VoicePool::VoicePool(float sample_rate, int num_voices, int num_modes,
+                     tMempool *pool, int num_outputs)
+    : VoicePool() {
+  Init(sample_rate, num_voices, num_modes, pool, num_outputs);
+}
+
+VoicePool::~VoicePool() {}
+
+size_t VoicePool::footprint() const {
+  size_t bytes = sizeof(*this);
+  for (int i = 0; i < num_voices_; ++i) {
+    bytes += voices_[i].string.footprint() - sizeof(StiffString);
+  }
+  return bytes;
+}
+
+bool VoicePool::Init(float sample_rate, int num_voices, int num_modes,
+                     tMempool *pool, int num_outputs) {
+  assert(num_voices > 0 && num_voices <= MAX_NUM_VOICES);
+  assert(num_outputs > 0 && num_outputs <= MAX_NUM_PICKUPS);
+  num_voices_ = num_voices;
+  num_outputs_ = num_outputs;
+  sample_rate_ = sample_rate;
+  set_silence_hold(silence_hold_);
+  bool ok = true;
+  for (int i = 0; i < num_voices_; ++i) {
+    Voice &v = voices_[i];
+    ok = v.string.Init(sample_rate, num_modes, pool, num_outputs) && ok;
+    v.string.set_deferred_plucks(true);
+    v.note = -1;
+    v.start = 0;
+    v.notes = 0;
+    v.released = false;
+    v.note_id = 0;
+    v.level = 0.0f;
+    v.sounding = false;
+    v.releasing = false;
+    v.quiet_samples = 0;
+    v.peak.store(0.0f, std::memory_order_relaxed);
+    v.finished.store(0, std::memory_order_relaxed);
+  }
+  events_.Clear();
+  return ok;
+}
+
+void VoicePool::set_silence_hold(float seconds) {
+  silence_hold_ = seconds;
+  silence_hold_samples_ = static_cast<int>(seconds * sample_rate_);
+}
+
+int VoicePool::num_active() const {
+  int count = 0;
+  for (int i = 0; i < num_voices_; ++i) {
+    if (voices_[i].active()) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+// Choose a voice to reuse: an idle voice if there is one, otherwise the
+// best candidate among released voices, otherwise among held voices.
+int VoicePool::FindVoiceToSteal() const {
+  int best = -1;
+  for (int i = 0; i < num_voices_; ++i) {
+    const Voice &v = voices_[i];
+    if (!v.active()) {
+      return i;
+    }
+    if (best < 0) {
+      best = i;
+      continue;
+    }
+    const Voice &b = voices_[best];
+    if (v.released != b.released) {
+      if (v.released) {
+        best = i;
+      }
+      continue;
+    }
+    bool better;
+    if (steal_policy_ == STEAL_QUIETEST) {
+      better = v.peak.load(std::memory_order_relaxed) <
+               b.peak.load(std::memory_order_relaxed);
+    } else {
+      // compare by age, allowing for wraparound of note_count_
+      better = static_cast<int>(v.start - b.start) < 0;
+    }
+    if (better) {
+      best = i;
+    }
+  }
+  return best;
+}
+
+// Choose and claim a voice for a new note (main loop side), returning its
+// index.
+int VoicePool::AllocateVoice(int note, float level) {
+  // retrigger the voice already playing this note, if any
+  int idx = -1;
+  for (int i = 0; i < num_voices_; ++i) {
+    if (voices_[i].active() && voices_[i].note == note) {
+      idx = i;
+      break;
+    }
+  }
+  if (idx < 0) {
+    idx = FindVoiceToSteal();
+  }
+  Voice &v = voices_[idx];
+  v.note = note;
+  v.start = note_count_++;
+  ++v.notes;
+  v.released = false;
+  // until Process() reports on the new note
+  v.peak.store(level, std::memory_order_relaxed);
+  return idx;
+}
+
+StiffString *VoicePool::NoteOff(int note) {
+  if (events_.full()) {
+    return nullptr;
+  }
+  for (int i = 0; i < num_voices_; ++i) {
+    Voice &v = voices_[i];
+    if (v.active() && !v.released && v.note == note) {
+      v.released = true;
+      Event e = {Event::RELEASE, i, v.notes, 0.0f, 0};
+      events_.Push(e);
+      return &v.string;
+    }
+  }
+  return nullptr;
+}
+
+void VoicePool::Process(const float *in, float *const *out, size_t size) {
+  Event e;
+  while (events_.Pop(&e)) {
+    Voice &v = voices_[e.voice];
+    if (e.type == Event::START) {
+      v.note_id = e.note_id;
+      v.level = e.level;
+      v.sounding = true;
+      v.releasing = false;
+      v.quiet_samples = 0;
+      v.string.StartPluck(e.plucks);
+    } else if (e.note_id == v.note_id) {
+      v.releasing = true;
+    }
+  }
+
+  for (int k = 0; k < num_outputs_; ++k) {
+    for (size_t j = 0; j < size; ++j) {
+      out[k][j] = 0.0f;
+    }
+  }
+  float buf[MAX_NUM_PICKUPS][MAX_CHUNK];
+  float *bufs[MAX_NUM_PICKUPS];
+  for (int k = 0; k < MAX_NUM_PICKUPS; ++k) {
+    bufs[k] = buf[k];
+  }
+  for (int i = 0; i < num_voices_; ++i) {
+    Voice &v = voices_[i];
+    if (!v.sounding) {
+      continue;
+    }
+    float peak = 0.0f;
+    for (size_t start = 0; start < size; start += MAX_CHUNK) {
+      size_t n = size - start < MAX_CHUNK ? size - start : MAX_CHUNK;
+      if (in != nullptr) {
+        v.string.Process(in + start, bufs, n);
+      } else {
+        v.string.Process(bufs, n);
+      }
+      for (int k = 0; k < num_outputs_; ++k) {
+        for (size_t j = 0; j < n; ++j) {
+          float sample = v.level * buf[k][j];
+          out[k][start + j] += sample;
+          peak = fmaxf(peak, fabsf(sample));
+        }
+      }
+    }
+    v.peak.store(peak, std::memory_order_relaxed);
+    // free released voices once they have died away: quiet for the whole
+    // hold time, which is longer than a period of the lowest notes
+    if (peak >= silence_threshold_) {
+      v.quiet_samples = 0;
+    } else if (v.quiet_samples < silence_hold_samples_) {
+      v.quiet_samples += size;
+    }
+    if (v.releasing && peak < silence_threshold_ &&
+        v.quiet_samples >= silence_hold_samples_) {
+      v.sounding = false;
+      v.finished.store(v.note_id, std::memory_order_release);
+    }
+  }
+}
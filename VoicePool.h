@@ -0,0 +1,176 @@
+/*
+  VoicePool.h
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+
+  A fixed pool of StiffString voices for polyphonic playing.  Voices are
+  allocated on NoteOn, marked as released on NoteOff, and returned to the
+  pool once they have decayed to silence.  When every voice is busy, one is
+  stolen: released voices are preferred over held ones, and within each
+  group the oldest (or quietest, depending on the policy) is chosen.
+
+  The pool never allocates memory; all voices are stored inline.
+
+  Process() may run in the audio callback while the other methods run in
+  the main loop.  The main loop allocates voices and sets up their strings
+  (see StiffString.h), and passes the start and release of each note to
+  Process() through a queue, which it drains at the start of every block.
+  In return, Process() reports each voice's level and when it has fallen
+  silent.
+
+  The voices' strings defer their plucks (see
+  StiffString::set_deferred_plucks()): the START event of a note carries
+  the pluck that setup() requested along with the note's level, and
+  Process() starts the pluck only when it applies the event.  So a stolen
+  voice never plays the new pluck at the old note's level, or while it is
+  still releasing the old note.  The new tuning, which setup() publishes
+  at once, may reach the old note's last block.
+
+  Each voice's string has num_outputs pickups, and Process() mixes each
+  pickup into its own output (see StiffString.h).
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include "SpscQueue.h"
+#include "StiffString.h"
+
+const int MAX_NUM_VOICES = 8;
+
+class VoicePool {
+ public:
+  enum StealPolicy {
+    STEAL_OLDEST,
+    STEAL_QUIETEST
+  };
+
+  VoicePool();
+  VoicePool(float sample_rate, int num_voices, int num_modes,
+            tMempool *pool, int num_outputs = 1);
+  ~VoicePool();
+
+  // Set up the voices, with their storage from pool.  Returns false if pool
+  // is out of memory.
+  bool Init(float sample_rate, int num_voices, int num_modes,
+            tMempool *pool, int num_outputs = 1);
+  // pool memory needed by Init()
+  static constexpr size_t StorageBytes(int num_voices, int num_modes,
+                                       int num_outputs = 1) {
+    return num_voices * StiffString::StorageBytes(num_modes, num_outputs);
+  }
+  // bytes used by the pool and its voices' storage
+  size_t footprint() const;
+
+  // Allocate a voice for the given note, with output level (0 to 1), and
+  // call setup(string) to tune and pluck its string.  The voice starts
+  // sounding at the next block.  Returns false, ignoring the note, if too
+  // many events are already waiting for Process().
+  template <typename F> bool NoteOn(int note, float level, F setup);
+  // Mark the voice playing the given note as released.  Returns the voice,
+  // or nullptr if the note is not sounding.
+  StiffString *NoteOff(int note);
+
+  // Render a block of samples from all sounding voices into out[k] for each
+  // output k, or into out for a pool with one output.
+  void Process(float *const *out, size_t size) { Process(nullptr, out, size); }
+  void Process(float *out, size_t size) { Process(nullptr, &out, size); }
+  // Process(), with the strings of the sounding voices driven by in (see
+  // StiffString.h), unless in is nullptr
+  void Process(const float *in, float *const *out, size_t size);
+
+  // Apply f to every voice, or only to voices whose note is still held
+  template <typename F> void ForEachVoice(F f);
+  template <typename F> void ForEachHeldVoice(F f);
+
+  int num_voices() const { return num_voices_; }
+  int num_outputs() const { return num_outputs_; }
+  int num_active() const;
+
+  // change parameters
+  void set_steal_policy(StealPolicy p) { steal_policy_ = p; }
+  void set_silence_threshold(float newValue) { silence_threshold_ = newValue; }
+  // A released voice is freed once its peak has stayed below the silence
+  // threshold for this long (50 ms by default), so that a low note passing
+  // through zero for a whole short block is not cut off
+  void set_silence_hold(float seconds);
+
+ private:
+  struct Voice {
+    StiffString string;
+    // main loop
+    int note;
+    unsigned int start;   // value of note_count_ when note started
+    uint32_t notes;       // notes started on this voice
+    bool released;
+    // audio callback
+    uint32_t note_id;     // value of notes for the note being played
+    float level;
+    bool sounding;
+    bool releasing;
+    int quiet_samples;    // since the peak last reached silence_threshold_
+    // written by the audio callback, read by the main loop
+    std::atomic<float> peak;  // peak level of any output over the last block
+    std::atomic<uint32_t> finished;  // note_id of the last note to die away
+
+    bool active() const {
+      return finished.load(std::memory_order_acquire) != notes;
+    }
+  };
+
+  // Note events, from the main loop to Process()
+  struct Event {
+    enum Type { START, RELEASE };
+    Type type;
+    int voice;
+    uint32_t note_id;
+    float level;
+    uint32_t plucks;  // START: the string's num_plucks() after setup()
+  };
+
+  int FindVoiceToSteal() const;
+  int AllocateVoice(int note, float level);
+
+  Voice voices_[MAX_NUM_VOICES];
+  int num_voices_;
+  int num_outputs_;
+  unsigned int note_count_;
+  StealPolicy steal_policy_;
+  float silence_threshold_;
+  float silence_hold_;  // seconds
+  int silence_hold_samples_;
+  float sample_rate_;
+  SpscQueue<Event, 4 * MAX_NUM_VOICES> events_;
+};
+
+template <typename F>
+bool VoicePool::NoteOn(int note, float level, F setup) {
+  if (events_.full()) {
+    return false;
+  }
+  int idx = AllocateVoice(note, level);
+  setup(voices_[idx].string);
+  Event e = {Event::START, idx, voices_[idx].notes, level,
+             voices_[idx].string.num_plucks()};
+  events_.Push(e);
+  return true;
+}
+
+template <typename F>
+void VoicePool::ForEachVoice(F f) {
+  for (int i = 0; i < num_voices_; ++i) {
+    f(voices_[i].string);
+  }
+}
+
+template <typename F>
+void VoicePool::ForEachHeldVoice(F f) {
+  for (int i = 0; i < num_voices_; ++i) {
+    if (voices_[i].active() && !voices_[i].released) {
+      f(voices_[i].string);
+    }
+  }
+}
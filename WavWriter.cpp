@@ -0,0 +1,141 @@
+/*
+  WavWriter.cpp
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+*/
+
+#include "WavWriter.h"
+#include <string.h>
+
+static void Put16(uint8_t *p, uint32_t value) {
+  p[0] = value & 0xff;
+  p[1] = (value >> 8) & 0xff;
+}
+
+static void Put32(uint8_t *p, uint32_t value) {
+  Put16(p, value & 0xffff);
+  Put16(p + 2, value >> 16);
+}
+
+// Header for either format.  Float files carry the extended fmt chunk and
+// a fact chunk, as the spec requires for non-PCM data.
+static size_t MakeHeader(uint8_t *h, int sample_rate, int num_channels,
+                         WavWriter::Format format, size_t num_frames) {
+  bool is_float = (format == WavWriter::FLOAT_32);
+  int bytes_per_sample = is_float ? 4 : 2;
+  uint32_t data_size = num_frames * num_channels * bytes_per_sample;
+  uint32_t fmt_size = is_float ? 18 : 16;
+  size_t header_size = 20 + fmt_size + (is_float ? 12 : 0) + 8;
+  memcpy(h, "RIFF", 4);
+  Put32(h + 4, header_size - 8 + data_size);
+  memcpy(h + 8, "WAVEfmt ", 8);
+  Put32(h + 16, fmt_size);
+  Put16(h + 20, is_float ? 3 : 1);
+  Put16(h + 22, num_channels);
+  Put32(h + 24, sample_rate);
+  Put32(h + 28, sample_rate * num_channels * bytes_per_sample);
+  Put16(h + 32, num_channels * bytes_per_sample);
+  Put16(h + 34, 8 * bytes_per_sample);
+  uint8_t *p = h + 36;
+  if (is_float) {
+    Put16(p, 0);
+    memcpy(p + 2, "fact", 4);
+    Put32(p + 6, 4);
+    Put32(p + 10, num_frames);
+    p += 14;
+  }
+  memcpy(p, "data", 4);
+  Put32(p + 4, data_size);
+  return header_size;
+}
+
+WavWriter::WavWriter()
+    : file_(nullptr), sample_rate_(0), num_channels_(0), format_(PCM_16),
+      num_frames_(0),
+      error_(false), buffer_used_(0) {}
+
+WavWriter::~WavWriter() {
+  Close();
+}
+
+bool WavWriter::Open(const char *path, int sample_rate, int num_channels,
+                     Format format) {
+  Close();
+  file_ = fopen(path, "wb");
+  if (!file_) {
+    return false;
+  }
+  sample_rate_ = sample_rate;
+  num_channels_ = num_channels;
+  format_ = format;
+  num_frames_ = 0;
+  error_ = false;
+  buffer_used_ = 0;
+  // placeholder header, rewritten by Close()
+  uint8_t header[64];
+  size_t header_size = MakeHeader(header, sample_rate, num_channels_,
+                                  format_, 0);
+  error_ = fwrite(header, 1, header_size, file_) != header_size;
+  return !error_;
+}
+
+void WavWriter::Write(const float *const *channels, size_t size) {
+  if (!file_) {
+    return;
+  }
+  size_t frame_bytes = num_channels_ * (format_ == FLOAT_32 ? 4 : 2);
+  for (size_t i = 0; i < size; ++i) {
+    if (buffer_used_ + frame_bytes > sizeof(buffer_)) {
+      Flush();
+    }
+    uint8_t *p = buffer_ + buffer_used_;
+    for (int c = 0; c < num_channels_; ++c) {
+      float sample = channels[c][i];
+      if (format_ == FLOAT_32) {
+        uint32_t bits;
+        memcpy(&bits, &sample, 4);
+        Put32(p, bits);
+        p += 4;
+      } else {
+        if (sample > 1.0f) {
+          sample = 1.0f;
+        } else if (sample < -1.0f) {
+          sample = -1.0f;
+        }
+        int16_t value = static_cast<int16_t>(sample * 32767.0f);
+        Put16(p, static_cast<uint16_t>(value));
+        p += 2;
+      }
+    }
+    buffer_used_ += frame_bytes;
+  }
+  num_frames_ += size;
+}
+
+void WavWriter::Flush() {
+  if (buffer_used_ > 0 &&
+      fwrite(buffer_, 1, buffer_used_, file_) != buffer_used_) {
+    error_ = true;
+  }
+  buffer_used_ = 0;
+}
+
+bool WavWriter::Close() {
+  if (!file_) {
+    return false;
+  }
+  Flush();
+  uint8_t header[64];
+  size_t header_size = MakeHeader(header, sample_rate_, num_channels_,
+                                  format_, num_frames_);
+  if (fseek(file_, 0, SEEK_SET) != 0 ||
+      fwrite(header, 1, header_size, file_) != header_size) {
+    error_ = true;
+  }
+  if (fclose(file_) != 0) {
+    error_ = true;
+  }
+  file_ = nullptr;
+  return !error_;
+}
@@ -0,0 +1,48 @@
+/*
+  WavWriter.h
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+
+  Buffered writer for WAV files, as 16-bit PCM or 32-bit float, for the host
+  tools.  Samples are interleaved into an internal buffer and written in
+  large chunks; the header sizes are filled in by Close().
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+class WavWriter {
+ public:
+  enum Format {
+    PCM_16,
+    FLOAT_32
+  };
+
+  WavWriter();
+  ~WavWriter();
+
+  bool Open(const char *path, int sample_rate, int num_channels,
+            Format format = PCM_16);
+  // Write size frames; channels[c] points to the samples for channel c.
+  void Write(const float *const *channels, size_t size);
+  // Flush the buffer, fill in the header and close the file.
+  bool Close();
+
+  size_t num_frames() const { return num_frames_; }
+
+ private:
+  void Flush();
+
+  FILE *file_;
+  int sample_rate_;
+  int num_channels_;
+  Format format_;
+  size_t num_frames_;
+  bool error_;
+  uint8_t buffer_[1 << 16];
+  size_t buffer_used_;
+};
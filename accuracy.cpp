@@ -0,0 +1,576 @@
+/*
+  accuracy.cpp
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+
+  What the oscillator approximations cost in sound, and what they save in
+  time.  Each variant renders a mode of a stiff string (the StiffString
+  model) for one second, which is compared with the mode computed in double
+  precision.  The results are CSV, one record per test mode and variant:
+
+    case            the test mode: string frequency and mode number n
+    variant         oscillator, and how its coefficients are computed
+    snr_db          signal to error ratio, after matching the amplitude and
+                    phase of the reference
+    freq_err_cents  error of the frequency, in cents
+    decay_err_pct   error of the decay rate, in percent
+    ns              render time per mode and sample
+
+  The frequency and decay rate are those of the damped sinusoid that best
+  fits the output over the whole second, so a frequency that drifts shows
+  in the SNR, but only its mean shows in the frequency error.  The
+  "retuned" variants are retuned every block, alternately kRetuneCents
+  sharp and flat, as a controller sweep would, and the reference follows
+  the same steps; their errors are those of the rescaling of the state that
+  keeps the amplitude continuous.
+
+  Each variant renders kNumCopies copies of the mode, of which only the
+  first is heard, so that the time is that of a full bank.
+
+  With -c, instead checks the tuning of the lowest note, A0 (27.5 Hz), where
+  the float waveguide's loop gain is closest to 1: each bank's fast
+  coefficients (set_freq_and_decay()) must be within kMaxFastCents of its
+  libm ones (set_freq()), and those within kMaxCents of the reference.
+  Exits with status 1 if not.
+
+  Usage: accuracy [-c]
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <chrono>
+#include <complex>
+#include "Cycle.h"
+#include "CycleBank.h"
+#include "DampedOscillator.h"
+#include "DampedOscillatorBank.h"
+#include "FixedOscillatorBank.h"
+#include "Simd.h"
+#include "leaflet.h"
+
+namespace {
+
+const float kSampleRate = 48000.0f;
+const int kNumSamples = 48000;  // one second
+const int kBlockSize = 64;
+const int kNumCopies = 64;
+const float kRetuneCents = 1.0f;
+const int kRampLength = 48;  // StringSynth's smoothing
+const double kPi = 3.14159265358979323846;
+const double kMaxCents = 3.0;  // the float waveguide is 2.3 cents flat at A0
+const double kMaxFastCents = 0.5;
+
+// Mode n (counting from 1) of a string, with the parameters of StiffString
+struct Case {
+  const char *name;
+  float freq_hz;
+  float stiffness;
+  float decay;
+  float decay_high_freq;
+  int n;
+};
+
+const Case kCases[] = {
+  {"27.5 Hz n=1", 27.5f, 0.01f, 0.001f, 1e-6f, 1},
+  {"110 Hz n=1", 110.0f, 0.01f, 0.001f, 1e-6f, 1},
+  {"110 Hz n=20", 110.0f, 0.01f, 0.001f, 1e-6f, 20},
+  {"110 Hz n=100", 110.0f, 0.01f, 0.001f, 1e-6f, 100},
+  {"55 Hz n=1 damped", 55.0f, 0.01f, 0.05f, 0.0f, 1},
+};
+
+// How the frequency and decay rate of a mode are computed: as
+// StiffString::UpdateOscillators() does (kLibm with set_fast_update(false),
+// or kFast), or with a first-order approximation of the undamped frequency
+// w0 or of the damping factor sqrt(1 - zeta^2)
+enum Formula {
+  kLibm,
+  kFast,
+  kW0FirstOrder,
+  kWFirstOrder
+};
+
+void ModeFreqAndDecay(const Case &c, Formula formula, float *freq_hz,
+                      float *decay) {
+  const float kappa_sq = c.stiffness * c.stiffness;
+  float sig, w;
+  if (formula == kFast) {
+    // n^2 by the same recurrence, for the same rounding
+    float n_sq = 0.0f;
+    for (int i = 0; i < c.n; ++i) {
+      n_sq += 2 * i + 1;
+    }
+    sig = c.decay + c.decay_high_freq * n_sq;
+    w = sqrtf(n_sq * (1.0f + kappa_sq * n_sq) - sig * sig);
+  } else {
+    const int n_sq = c.n * c.n;
+    sig = c.decay + c.decay_high_freq * n_sq;
+    float w0 = formula == kW0FirstOrder
+               ? c.n * (1.0f + 0.5f * kappa_sq * n_sq)
+               : c.n * sqrtf(1.0f + kappa_sq * n_sq);
+    float zeta = sig / w0;
+    w = formula == kWFirstOrder ? w0 * (1.0f - 0.5f * zeta * zeta)
+                                : w0 * sqrtf(1.0f - zeta * zeta);
+  }
+  *freq_hz = c.freq_hz * w;
+  *decay = c.freq_hz * sig;
+}
+
+void ExactFreqAndDecay(const Case &c, double *freq_hz, double *decay) {
+  const double n = c.n;
+  const double kappa = c.stiffness;
+  const double sig = c.decay + c.decay_high_freq * n * n;
+  const double w0 = n * sqrt(1.0 + kappa * kappa * n * n);
+  const double zeta = sig / w0;
+  *freq_hz = c.freq_hz * w0 * sqrt(1.0 - zeta * zeta);
+  *decay = c.freq_hz * sig;
+}
+
+// Frequency factor for block b of a retuned variant
+double RetuneFactor(int b) {
+  if (b == 0) {
+    return 1.0;
+  }
+  return pow(2.0, (b % 2 ? kRetuneCents : -kRetuneCents) / 1200.0);
+}
+
+tMempool *pool;
+
+void DisableRetirement(DampedOscillatorBank *bank) {
+  bank->set_retire_level(0.0f);
+}
+template <class Bank>
+void DisableRetirement(Bank *) {}
+
+// Modes rendered by a bank (DampedOscillatorBank, FixedOscillatorBank or
+// CycleBank), as in StiffString
+template <class Bank>
+class BankVariant {
+ public:
+  explicit BankVariant(Formula formula, bool retune = false,
+                       int ramp_length = 0)
+      : bank_(kSampleRate), formula_(formula), retune_(retune),
+        ramp_length_(ramp_length) {}
+
+  bool Init() {
+    bank_.set_ramp_length(ramp_length_);
+    DisableRetirement(&bank_);
+    return bank_.Init(kNumCopies, pool);
+  }
+  bool retunes() const { return retune_; }
+  int ramp_length() const { return ramp_length_; }
+
+  void Start(const Case &c) {
+    ModeFreqAndDecay(c, formula_, &freq_hz_, &decay_);
+    for (int i = 0; i < kNumCopies; ++i) {
+      SetMode(i, freq_hz_);
+      bank_.set_gain(i, i == 0 ? 1.0f : 0.0f);
+    }
+    bank_.set_num_active(kNumCopies);
+    bank_.Publish();
+    bank_.Reset();
+  }
+  void Retune(double factor) {
+    for (int i = 0; i < kNumCopies; ++i) {
+      SetMode(i, freq_hz_ * factor);
+    }
+    bank_.Publish();
+  }
+  void Process(float *out, size_t size) {
+    // The bank adds to out
+    for (size_t j = 0; j < size; ++j) {
+      out[j] = 0.0f;
+    }
+    bank_.Process(out, size);
+  }
+
+ private:
+  void SetMode(int i, float freq_hz) {
+    if (formula_ == kFast) {
+      bank_.set_freq_and_decay(i, freq_hz, decay_);
+    } else {
+      bank_.set_freq(i, freq_hz);
+      bank_.set_decay(i, decay_);
+    }
+  }
+
+  Bank bank_;
+  Formula formula_;
+  bool retune_;
+  int ramp_length_;
+  float freq_hz_;
+  float decay_;
+};
+
+// Modes rendered by wavetable oscillators (see Cycle.h) with an envelope
+// scaled every sample, as in CycleBank
+template <int kTableBits, int kOrder>
+class CycleVariant {
+ public:
+  bool Init() { return true; }
+  bool retunes() const { return false; }
+  int ramp_length() const { return 0; }
+
+  void Start(const Case &c) {
+    float freq_hz, decay;
+    ModeFreqAndDecay(c, kLibm, &freq_hz, &decay);
+    decay_ = expf(-decay * TWO_PI / kSampleRate);
+    for (int i = 0; i < kNumCopies; ++i) {
+      cycles_[i].set_sample_rate(kSampleRate);
+      cycles_[i].set_freq(freq_hz);
+      cycles_[i].set_phase(0.0f);
+      envelopes_[i] = 1.0f;
+    }
+  }
+  void Retune(double factor) {}
+  void Process(float *out, size_t size) {
+    float buf[kBlockSize];
+    for (size_t j = 0; j < size; ++j) {
+      out[j] = 0.0f;
+    }
+    for (int i = 0; i < kNumCopies; ++i) {
+      const float gain = i == 0 ? 1.0f : 0.0f;
+      float envelope = envelopes_[i];
+      cycles_[i].Process(buf, size);
+      for (size_t j = 0; j < size; ++j) {
+        out[j] += gain * envelope * buf[j];
+        envelope *= decay_;
+      }
+      envelopes_[i] = envelope;
+    }
+  }
+
+ private:
+  BasicCycle<kTableBits, kOrder> cycles_[kNumCopies];
+  float envelopes_[kNumCopies];
+  float decay_;
+};
+
+// Modes rendered by DampedOscillator, which rescales its state itself when
+// retuned
+class DampedOscillatorVariant {
+ public:
+  bool Init() { return true; }
+  bool retunes() const { return true; }
+  int ramp_length() const { return 0; }
+
+  void Start(const Case &c) {
+    float decay;
+    ModeFreqAndDecay(c, kLibm, &freq_hz_, &decay);
+    for (int i = 0; i < kNumCopies; ++i) {
+      // A fresh oscillator starts at its first set_freq()
+      oscs_[i] = DampedOscillator(kSampleRate);
+      oscs_[i].set_freq(freq_hz_);
+      oscs_[i].set_decay(decay);
+    }
+  }
+  void Retune(double factor) {
+    for (int i = 0; i < kNumCopies; ++i) {
+      oscs_[i].set_freq(freq_hz_ * factor);
+    }
+  }
+  void Process(float *out, size_t size) {
+    for (size_t j = 0; j < size; ++j) {
+      out[j] = 0.0f;
+    }
+    for (int i = 0; i < kNumCopies; ++i) {
+      oscs_[i].Process(out, size, 1.0f, i == 0 ? 1.0f : 0.0f);
+    }
+  }
+
+ private:
+  DampedOscillator oscs_[kNumCopies];
+  float freq_hz_;
+};
+
+// Complex amplitude C of y[begin, end) that best fits, by least squares,
+// Re(C exp((i theta - alpha) j))
+std::complex<double> FitSegment(const float *y, int begin, int end,
+                                double theta, double alpha) {
+  double uu = 0.0, uv = 0.0, vv = 0.0, uy = 0.0, vy = 0.0;
+  for (int j = begin; j < end; ++j) {
+    const double envelope = exp(-alpha * j);
+    const double u = envelope * cos(theta * j);
+    const double v = envelope * sin(theta * j);
+    uu += u * u;
+    uv += u * v;
+    vv += v * v;
+    uy += u * y[j];
+    vy += v * y[j];
+  }
+  const double det = uu * vv - uv * uv;
+  const double a = (uy * vv - vy * uv) / det;
+  const double b = (uu * vy - uv * uy) / det;
+  return std::complex<double>(a, -b);
+}
+
+// Fit a damped sinusoid exp((i theta - alpha) j) to y, starting from theta
+// and alpha, which are refined in place.  The amplitude fitted to each
+// segment of y turns at the error of theta, and shrinks or grows at the
+// error of alpha, which are found by (weighted) linear regression.  The
+// first segments span a few periods, so the turn per segment can be
+// unwrapped for frequency errors of up to 10%; later passes use longer
+// segments, for accuracy.
+void FitDampedSinusoid(const float *y, int size, double *theta,
+                       double *alpha) {
+  const int kMinSegments = 8;
+  int length = static_cast<int>(ceil(5.0 * kPi / *theta));
+  for (; length <= size / kMinSegments; length *= 16) {
+    double sw = 0.0, st = 0.0, sp = 0.0, sl = 0.0, stt = 0.0, stp = 0.0,
+           stl = 0.0;
+    double prev_phase = 0.0;
+    bool first = true;
+    for (int begin = 0; begin + length <= size; begin += length) {
+      const std::complex<double> c =
+          FitSegment(y, begin, begin + length, *theta, *alpha);
+      const double t = begin + 0.5 * length;
+      // Weight by the segment's energy
+      const double weight = std::norm(c) * exp(-2.0 * *alpha * t);
+      if (!(weight > 0.0)) {
+        continue;
+      }
+      double phase = std::arg(c);
+      if (!first) {
+        phase = prev_phase + remainder(phase - prev_phase, 2.0 * kPi);
+      }
+      first = false;
+      prev_phase = phase;
+      const double log_amplitude = log(std::abs(c));
+      sw += weight;
+      st += weight * t;
+      sp += weight * phase;
+      sl += weight * log_amplitude;
+      stt += weight * t * t;
+      stp += weight * t * phase;
+      stl += weight * t * log_amplitude;
+    }
+    const double var = sw * stt - st * st;
+    if (!(var > 0.0)) {
+      return;
+    }
+    *theta += (sw * stp - st * sp) / var;
+    *alpha -= (sw * stl - st * sl) / var;
+  }
+}
+
+// Signal to error ratio of y against a damped sinusoid with decay rate
+// decay and phase phase[j], with the amplitude and phase that fit best
+double SignalToError(const float *y, const double *phase, int size,
+                     double decay) {
+  const double r = exp(-2.0 * kPi * decay / kSampleRate);
+  double uu = 0.0, uv = 0.0, vv = 0.0, uy = 0.0, vy = 0.0;
+  double envelope = 1.0;
+  for (int j = 0; j < size; ++j) {
+    const double u = envelope * cos(phase[j]);
+    const double v = envelope * sin(phase[j]);
+    uu += u * u;
+    uv += u * v;
+    vv += v * v;
+    uy += u * y[j];
+    vy += v * y[j];
+    envelope *= r;
+  }
+  const double det = uu * vv - uv * uv;
+  const double a = (uy * vv - vy * uv) / det;
+  const double b = (uu * vy - uv * uy) / det;
+  double signal = 0.0, error = 0.0;
+  envelope = 1.0;
+  for (int j = 0; j < size; ++j) {
+    const double fit = envelope * (a * cos(phase[j]) + b * sin(phase[j]));
+    signal += fit * fit;
+    error += (y[j] - fit) * (y[j] - fit);
+    envelope *= r;
+  }
+  return 10.0 * log10(signal / error);
+}
+
+struct Result {
+  double snr_db;
+  double freq_err_cents;
+  double decay_err_pct;
+  double ns;  // per mode and sample
+};
+
+float out[kNumSamples];
+double phase[kNumSamples];
+
+// Render c with variant, timing the best of three runs
+template <class Variant>
+Result Measure(const Case &c, Variant *variant) {
+  using Clock = std::chrono::steady_clock;
+  double best = 1e30;
+  for (int run = 0; run < 3; ++run) {
+    auto start = Clock::now();
+    variant->Start(c);
+    for (int j = 0; j < kNumSamples; j += kBlockSize) {
+      if (variant->retunes() && j > 0) {
+        variant->Retune(RetuneFactor(j / kBlockSize));
+      }
+      variant->Process(out + j, kBlockSize);
+    }
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    if (elapsed.count() < best) {
+      best = elapsed.count();
+    }
+  }
+
+  // The reference's phase follows the retuning, ramped as in the bank
+  double freq_hz, decay;
+  ExactFreqAndDecay(c, &freq_hz, &decay);
+  const double omega = 2.0 * kPi * freq_hz / kSampleRate;
+  const int ramp_length = variant->ramp_length();
+  double omega_prev = omega, omega_block = omega, theta = 0.0;
+  for (int j = 0; j < kNumSamples; ++j) {
+    const int k = j % kBlockSize;
+    if (k == 0) {
+      omega_prev = omega_block;
+      omega_block = omega * (variant->retunes()
+                             ? RetuneFactor(j / kBlockSize) : 1.0);
+    }
+    double w = omega_block;
+    if (k < ramp_length) {
+      w = omega_prev + (omega_block - omega_prev) * (k + 1) / ramp_length;
+    }
+    theta += w;
+    phase[j] = theta;
+  }
+
+  const double alpha = 2.0 * kPi * decay / kSampleRate;
+  double fit_theta = omega, fit_alpha = alpha;
+  FitDampedSinusoid(out, kNumSamples, &fit_theta, &fit_alpha);
+  return {SignalToError(out, phase, kNumSamples, decay),
+          1200.0 * log2(fit_theta / omega), 100.0 * (fit_alpha / alpha - 1.0),
+          best / (static_cast<double>(kNumSamples) * kNumCopies)};
+}
+
+template <class Variant>
+bool InitVariant(const char *name, Variant *variant) {
+  // Each variant has the pool to itself
+  mpool_reset(pool);
+  if (!variant->Init()) {
+    fprintf(stderr, "accuracy: out of memory for %s\n", name);
+    return false;
+  }
+  return true;
+}
+
+template <class Variant>
+void MeasureAll(const char *name, Variant *variant) {
+  if (!InitVariant(name, variant)) {
+    return;
+  }
+  for (const Case &c : kCases) {
+    Result r = Measure(c, variant);
+    printf("%s,%s,%.1f,%.4f,%.3f,%.3f\n", c.name, name, r.snr_db,
+           r.freq_err_cents, r.decay_err_pct, r.ns);
+  }
+}
+
+// Tuning error of Bank at A0 with formula, or NAN if out of memory
+template <class Bank>
+double CentsAtA0(const char *name, Formula formula) {
+  const Case a0 = {"27.5 Hz n=1", 27.5f, 0.01f, 0.001f, 1e-6f, 1};
+  BankVariant<Bank> v(formula);
+  if (!InitVariant(name, &v)) {
+    return NAN;
+  }
+  return Measure(a0, &v).freq_err_cents;
+}
+
+template <class Bank>
+bool CheckTuning(const char *name) {
+  const double libm = CentsAtA0<Bank>(name, kLibm);
+  const double fast = CentsAtA0<Bank>(name, kFast);
+  const bool ok = fabs(libm) <= kMaxCents && fabs(fast - libm) <= kMaxFastCents;
+  printf("%s: A0 %.4f cents with libm, %.4f fast: %s\n", name, libm, fast,
+         ok ? "ok" : "FAILED");
+  return ok;
+}
+
+void Usage() {
+  fprintf(stderr, "usage: accuracy [-c]\n");
+  exit(1);
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  bool check = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "c")) != -1) {
+    switch (opt) {
+      case 'c': check = true; break;
+      default: Usage();
+    }
+  }
+  if (optind != argc) {
+    Usage();
+  }
+  static char memory[DampedOscillatorBank::StorageBytes(kNumCopies) +
+                     FixedOscillatorBank::StorageBytes(kNumCopies) +
+                     CycleBank::StorageBytes(kNumCopies)];
+  LEAF *leaf = LEAF_init(kSampleRate, memory, sizeof(memory), nullptr);
+  mpool_create_arena(memory, sizeof(memory), leaf->mempool);
+  pool = leaf->mempool;
+  // As in StringSynth::Process()
+  ScopedFlushToZero flush_to_zero;
+
+  if (check) {
+    bool ok = CheckTuning<DampedOscillatorBank>("DampedOscillatorBank");
+    ok = CheckTuning<FixedOscillatorBank>("FixedOscillatorBank") && ok;
+    return ok ? 0 : 1;
+  }
+
+  printf("case,variant,snr_db,freq_err_cents,decay_err_pct,ns\n");
+  {
+    BankVariant<DampedOscillatorBank> v(kLibm);
+    MeasureAll("DampedOscillatorBank", &v);
+  }
+  {
+    BankVariant<DampedOscillatorBank> v(kFast);
+    MeasureAll("DampedOscillatorBank fast", &v);
+  }
+  {
+    BankVariant<DampedOscillatorBank> v(kW0FirstOrder);
+    MeasureAll("DampedOscillatorBank w0 first order", &v);
+  }
+  {
+    BankVariant<DampedOscillatorBank> v(kWFirstOrder);
+    MeasureAll("DampedOscillatorBank w first order", &v);
+  }
+  {
+    BankVariant<DampedOscillatorBank> v(kLibm, true);
+    MeasureAll("DampedOscillatorBank retuned", &v);
+  }
+  {
+    BankVariant<DampedOscillatorBank> v(kLibm, true, kRampLength);
+    MeasureAll("DampedOscillatorBank retuned with ramp", &v);
+  }
+  {
+    DampedOscillatorVariant v;
+    MeasureAll("DampedOscillator retuned", &v);
+  }
+  {
+    BankVariant<FixedOscillatorBank> v(kLibm);
+    MeasureAll("FixedOscillatorBank", &v);
+  }
+  {
+    BankVariant<CycleBank> v(kLibm);
+    MeasureAll("CycleBank", &v);
+  }
+  {
+    static CycleVariant<11, 0> v;
+    MeasureAll("BasicCycle<11 0>", &v);
+  }
+  {
+    static CycleVariant<8, 3> v;
+    MeasureAll("BasicCycle<8 3>", &v);
+  }
+  {
+    static CycleVariant<8, 1> v;
+    MeasureAll("BasicCycle<8 1>", &v);
+  }
+  return 0;
+}
@@ -0,0 +1,337 @@
+/*
+  batchrender.cpp
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+
+  Batch renderer for sample libraries: renders one StiffString note for
+  each combination of preset and MIDI note, on every core of the host, and
+  writes it to a WAV file for each velocity.  See Makefile.host.
+
+  Usage: batchrender [options] output_dir
+    -j threads  worker threads (default: one per core)
+    -r rate     sample rate (default 48000)
+    -m modes    number of modes (default 60)
+    -s seconds  length of each note (default 4)
+    -n lo-hi    range of MIDI notes (default 21-108)
+    -V v1,v2..  velocities (default 32,64,96,127)
+    -p s,d,pl,pu  add a preset: stiffness, decay, pluck and pickup positions
+                (repeat for several; default the StiffString defaults)
+    -f          write 32-bit float instead of 16-bit PCM
+
+  Files are named p<preset>_n<note>_v<velocity>.wav.  As in StringSynth,
+  the velocity only scales the output linearly, so each note is rendered
+  once, and the velocities are written from the one buffer.
+
+  Each worker thread has a string, a pool and a buffer of its own, and
+  writes its files itself, so the threads share nothing but the job queues.
+  Each job is one note of one preset.  The jobs
+  are dealt out in equal runs, one per thread, which the thread works
+  through from the front; a thread that runs out takes jobs from the back
+  of another's run.  High notes, with fewer modes below Nyquist, take less
+  time than low ones, and stealing evens out the difference.  How well
+  this scales with the number of cores has not been measured.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "NoteTable.h"
+#include "Simd.h"
+#include "StiffString.h"
+#include "WavWriter.h"
+#include "leaflet.h"
+
+const int BLOCK_SIZE = 256;
+const int MAX_NUM_THREADS = 256;
+
+struct Preset {
+  float stiffness;
+  float decay;
+  float pluck_pos;
+  float pickup_pos;
+};
+
+struct Job {
+  int preset;
+  int note;
+};
+
+struct Options {
+  int sample_rate = 48000;
+  int num_modes = 60;
+  double seconds = 4.0;
+  const char *output_dir = nullptr;
+  WavWriter::Format format = WavWriter::PCM_16;
+  std::vector<Preset> presets;
+  std::vector<int> velocities = {32, 64, 96, 127};
+};
+
+// A worker thread's jobs, and everything it renders them with
+struct Worker {
+  std::mutex mutex;  // guards jobs, which other workers may steal from
+  std::deque<int> jobs;
+  StiffString string;
+  tMempool pool;
+  std::unique_ptr<char[]> memory;
+  std::vector<float> buffer;  // the note being rendered
+  int num_rendered = 0;
+  int num_stolen = 0;
+};
+
+static Options options;
+static std::vector<Job> jobs;
+static std::unique_ptr<Worker[]> workers;
+static int num_workers;
+static std::atomic<int> num_failed(0);
+
+void Usage() {
+  fprintf(stderr,
+          "usage: batchrender [-j threads] [-r rate] [-m modes] [-s seconds]\n"
+          "                   [-n lo-hi] [-V v1,v2,...] [-p s,d,pl,pu]... "
+          "[-f]\n"
+          "                   output_dir\n");
+  exit(1);
+}
+
+// Take the next job of worker w, from the front of its own run, or else
+// from the back of another's.  Returns -1 when there are none left.
+int NextJob(int w) {
+  Worker &self = workers[w];
+  {
+    std::lock_guard<std::mutex> lock(self.mutex);
+    if (!self.jobs.empty()) {
+      int job = self.jobs.front();
+      self.jobs.pop_front();
+      return job;
+    }
+  }
+  // No jobs are added once the workers start, so one pass finding every
+  // run empty means there is nothing left
+  for (int k = 1; k < num_workers; ++k) {
+    Worker &victim = workers[(w + k) % num_workers];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.jobs.empty()) {
+      int job = victim.jobs.back();
+      victim.jobs.pop_back();
+      ++self.num_stolen;
+      return job;
+    }
+  }
+  return -1;
+}
+
+// Write the note in buffer, scaled for velocity, as 16-bit PCM or float
+bool WriteVelocity(const Job &job, int velocity,
+                   const std::vector<float> &buffer) {
+  char path[1024];
+  snprintf(path, sizeof(path), "%s/p%d_n%03d_v%03d.wav", options.output_dir,
+           job.preset, job.note, velocity);
+  WavWriter wav;
+  if (!wav.Open(path, options.sample_rate, 1, options.format)) {
+    fprintf(stderr, "batchrender: cannot open %s\n", path);
+    return false;
+  }
+  const float level = velocity / 127.0f;
+  float block[BLOCK_SIZE];
+  const float *channels[] = {block};
+  for (size_t frame = 0; frame < buffer.size(); frame += BLOCK_SIZE) {
+    size_t size = buffer.size() - frame < BLOCK_SIZE ? buffer.size() - frame
+                                                     : BLOCK_SIZE;
+    for (size_t i = 0; i < size; ++i) {
+      block[i] = level * buffer[frame + i];
+    }
+    wav.Write(channels, size);
+  }
+  if (!wav.Close()) {
+    fprintf(stderr, "batchrender: error writing %s\n", path);
+    return false;
+  }
+  return true;
+}
+
+// Render the note of job once, and write it for every velocity
+bool Render(const Job &job, Worker *worker) {
+  const Preset &p = options.presets[job.preset];
+  StiffString &s = worker->string;
+  s.set_stiffness(p.stiffness);
+  s.set_decay(p.decay);
+  s.set_pluck_pos(p.pluck_pos);
+  s.set_pickup_pos(p.pickup_pos);
+  s.set_freq(midi_to_freq(job.note));
+  s.SetInitialAmplitudes();
+
+  std::vector<float> &buffer = worker->buffer;
+  for (size_t frame = 0; frame < buffer.size(); frame += BLOCK_SIZE) {
+    size_t size = buffer.size() - frame < BLOCK_SIZE ? buffer.size() - frame
+                                                     : BLOCK_SIZE;
+    s.Process(&buffer[frame], size);
+  }
+  bool ok = true;
+  for (int velocity : options.velocities) {
+    ok = WriteVelocity(job, velocity, buffer) && ok;
+  }
+  return ok;
+}
+
+void Work(int w) {
+  // The FTZ and DAZ flags belong to the thread
+  ScopedFlushToZero flush_to_zero;
+  Worker &self = workers[w];
+  for (int job = NextJob(w); job >= 0; job = NextJob(w)) {
+    if (!Render(jobs[job], &self)) {
+      ++num_failed;
+    }
+    ++self.num_rendered;
+  }
+}
+
+// Parse exactly num_values comma-separated floats
+bool ParseFloats(const char *arg, float *values, int num_values) {
+  for (int i = 0; i < num_values; ++i) {
+    char *end;
+    values[i] = strtof(arg, &end);
+    if (end == arg || *end != (i + 1 < num_values ? ',' : '\0')) {
+      return false;
+    }
+    arg = end + 1;
+  }
+  return true;
+}
+
+bool ParseVelocities(const char *arg, std::vector<int> *velocities) {
+  velocities->clear();
+  while (true) {
+    char *end;
+    long v = strtol(arg, &end, 10);
+    if (end == arg || v < 1 || v > 127 || (*end != ',' && *end != '\0')) {
+      return false;
+    }
+    velocities->push_back(v);
+    if (*end == '\0') {
+      return true;
+    }
+    arg = end + 1;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  num_workers = std::thread::hardware_concurrency();
+  int low_note = 21;
+  int high_note = 108;
+  int opt;
+  while ((opt = getopt(argc, argv, "j:r:m:s:n:V:p:f")) != -1) {
+    switch (opt) {
+      case 'j': num_workers = atoi(optarg); break;
+      case 'r': options.sample_rate = atoi(optarg); break;
+      case 'm': options.num_modes = atoi(optarg); break;
+      case 's': options.seconds = atof(optarg); break;
+      case 'n':
+        if (sscanf(optarg, "%d-%d", &low_note, &high_note) != 2) {
+          Usage();
+        }
+        break;
+      case 'V':
+        if (!ParseVelocities(optarg, &options.velocities)) {
+          Usage();
+        }
+        break;
+      case 'p': {
+        float v[4];
+        if (!ParseFloats(optarg, v, 4)) {
+          Usage();
+        }
+        options.presets.push_back({v[0], v[1], v[2], v[3]});
+      }
+        break;
+      case 'f': options.format = WavWriter::FLOAT_32; break;
+      default: Usage();
+    }
+  }
+  if (argc - optind != 1 || options.num_modes < 1 ||
+      options.num_modes > MAX_NUM_MODES || options.seconds <= 0.0 ||
+      low_note < 0 || high_note > 127 || low_note > high_note) {
+    Usage();
+  }
+  if (num_workers < 1) {
+    num_workers = 1;
+  } else if (num_workers > MAX_NUM_THREADS) {
+    num_workers = MAX_NUM_THREADS;
+  }
+  options.output_dir = argv[optind];
+  if (options.presets.empty()) {
+    // the StiffString defaults
+    options.presets.push_back({0.001f, 0.0001f, 0.2f, 0.3f});
+  }
+
+  for (int p = 0; p < static_cast<int>(options.presets.size()); ++p) {
+    for (int note = low_note; note <= high_note; ++note) {
+      jobs.push_back({p, note});
+    }
+  }
+  const int num_jobs = jobs.size();
+  if (num_workers > num_jobs) {
+    num_workers = num_jobs;
+  }
+
+  // Only the workers' pools come from LEAF, whose own pool goes unused
+  static char leaf_memory[1024];
+  LEAF *leaf = LEAF_init(options.sample_rate, leaf_memory,
+                         sizeof(leaf_memory), nullptr);
+  const size_t memory_size = StiffString::StorageBytes(options.num_modes);
+  const size_t num_frames = static_cast<size_t>(options.seconds *
+                                                options.sample_rate);
+  workers.reset(new Worker[num_workers]);
+  for (int w = 0; w < num_workers; ++w) {
+    Worker &worker = workers[w];
+    worker.memory.reset(new char[memory_size]);
+    worker.buffer.resize(num_frames);
+    worker.pool.leaf = leaf;
+    mpool_create_arena(worker.memory.get(), memory_size, &worker.pool);
+    if (!worker.string.Init(options.sample_rate, options.num_modes,
+                            &worker.pool)) {
+      fprintf(stderr, "batchrender: out of string memory\n");
+      return 1;
+    }
+    for (int j = w * num_jobs / num_workers;
+         j < (w + 1) * num_jobs / num_workers; ++j) {
+      worker.jobs.push_back(j);
+    }
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int w = 1; w < num_workers; ++w) {
+    threads.emplace_back(Work, w);
+  }
+  Work(0);
+  for (std::thread &t : threads) {
+    t.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  std::chrono::duration<double> elapsed = end - start;
+  const int num_files = num_jobs * options.velocities.size();
+  double audio_seconds = num_jobs * options.seconds;
+  fprintf(stderr,
+          "%d notes (%d files), %.1f s of audio rendered in %.3f s on %d "
+          "threads (%.1fx real time)\n",
+          num_jobs, num_files, audio_seconds, elapsed.count(), num_workers,
+          audio_seconds / elapsed.count());
+  for (int w = 0; w < num_workers; ++w) {
+    fprintf(stderr, "thread %d: %d notes, %d stolen\n", w,
+            workers[w].num_rendered, workers[w].num_stolen);
+  }
+  if (num_failed > 0) {
+    fprintf(stderr, "batchrender: %d notes failed\n", num_failed.load());
+    return 1;
+  }
+  return 0;
+}
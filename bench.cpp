@@ -0,0 +1,549 @@
+/*
+  bench.cpp
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+
+  Microbenchmarks for the DSP primitives and the leaflet memory pool (with
+  first-fit and, prefixed "tlsf:", TLSF pools), with results as CSV
+  (default) or JSON, one record per measurement:
+
+    benchmark   what was timed (suffixed ":p999" or ":max" for the 99.9th
+                percentile or maximum of a series of calls)
+    modes       number of modes (for mempool: free-list fragments, or the
+                most live blocks in the stress test)
+    block_size  samples per call (0 where not applicable)
+    value       time in nanoseconds
+    unit        what the time is per: sample, mode_sample or call
+
+  Usage: bench [-j] [-q]
+    -j  JSON output
+    -q  quick run (shorter timings, fewer sizes)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "Cycle.h"
+#include "DampedOscillator.h"
+#include "Oscillator.h"
+#include "Simd.h"
+#include "StiffString.h"
+#include "StringBank.h"
+#include "leaflet.h"
+
+namespace {
+
+bool json = false;
+bool first_record = true;
+double min_time = 0.02;  // seconds per timing run
+
+volatile float sink;
+
+void Record(const char *benchmark, int modes, int block_size, double value,
+            const char *unit) {
+  if (json) {
+    printf("%s\n  {\"benchmark\": \"%s\", \"modes\": %d, \"block_size\": %d, "
+           "\"value\": %.4f, \"unit\": \"%s\"}",
+           first_record ? "[" : ",", benchmark, modes, block_size, value,
+           unit);
+  } else {
+    if (first_record) {
+      printf("benchmark,modes,block_size,value,unit\n");
+    }
+    printf("%s,%d,%d,%.4f,%s\n", benchmark, modes, block_size, value, unit);
+  }
+  first_record = false;
+}
+
+// Time f(n) (which does n operations), doubling n until a run takes at
+// least min_time; returns the best of three runs, in nanoseconds per
+// operation.
+template <typename F>
+double TimePerOp(F f) {
+  using Clock = std::chrono::steady_clock;
+  long n = 1;
+  while (true) {
+    auto start = Clock::now();
+    f(n);
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+    if (elapsed.count() >= min_time) {
+      break;
+    }
+    n *= 2;
+  }
+  double best = 1e30;
+  for (int run = 0; run < 3; ++run) {
+    auto start = Clock::now();
+    f(n);
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    if (elapsed.count() < best) {
+      best = elapsed.count();
+    }
+  }
+  return best / n;
+}
+
+void BenchPrimitives() {
+  const float sr = 48000.0f;
+  static Oscillator osc(sr);
+  osc.set_freq(440.0f);
+  Record("Oscillator::Tick", 1, 1, TimePerOp([](long n) {
+    float sum = 0.0f;
+    for (long i = 0; i < n; ++i) sum += osc.Tick();
+    sink = sum;
+  }), "sample");
+
+  static DampedOscillator damped(sr);
+  damped.set_freq(440.0f);
+  damped.set_decay(0.0f);
+  Record("DampedOscillator::Tick", 1, 1, TimePerOp([](long n) {
+    float sum = 0.0f;
+    for (long i = 0; i < n; ++i) sum += damped.Tick();
+    sink = sum;
+  }), "sample");
+
+  static Cycle cycle(sr);
+  cycle.set_freq(440.0f);
+  Record("Cycle::Tick", 1, 1, TimePerOp([](long n) {
+    float sum = 0.0f;
+    for (long i = 0; i < n; ++i) sum += cycle.Tick();
+    sink = sum;
+  }), "sample");
+
+  static float buf[64];
+  Record("Cycle::Process", 1, 64, TimePerOp([](long n) {
+    for (long i = 0; i < n; i += 64) cycle.Process(buf, 64);
+    sink = buf[0];
+  }), "sample");
+}
+
+// Rendering and parameter updates for a string of type String (such as
+// StiffString); benchmark names start with name.
+template <class String>
+void BenchStiffString(const std::string &name,
+                      const std::vector<int> &mode_counts,
+                      const std::vector<int> &block_sizes) {
+  static String string;
+  alignas(SIMD_ALIGN) static char memory[String::StorageBytes(MAX_NUM_MODES)];
+  static float buf[1024];
+  // Storage for the most modes, so that later Init()s never reallocate
+  LEAF *leaf = LEAF_init(48000.0f, memory, sizeof(memory), nullptr);
+  mpool_create_arena(memory, sizeof(memory), leaf->mempool);
+  string.Init(48000.0f,
+              *std::max_element(mode_counts.begin(), mode_counts.end()),
+              leaf->mempool);
+  for (int num_modes : mode_counts) {
+    string.Init(48000.0f, num_modes, leaf->mempool);
+    // a low note with no decay, so that every mode stays active and audible
+    string.set_decay(0.0f);
+    string.set_decay_high_freq(0.0f);
+    string.set_freq(20.0f);
+    string.SetInitialAmplitudes();
+    int active = string.num_active_modes();
+
+    double t = TimePerOp([](long n) {
+      float sum = 0.0f;
+      for (long i = 0; i < n; ++i) sum += string.Tick();
+      sink = sum;
+    });
+    Record((name + "::Tick").c_str(), active, 1, t, "sample");
+    Record((name + "::Tick").c_str(), active, 1, t / active, "mode_sample");
+
+    for (int block_size : block_sizes) {
+      t = TimePerOp([=](long n) {
+        for (long i = 0; i < n; ++i) string.Process(buf, block_size);
+        sink = buf[0];
+      }) / block_size;
+      Record((name + "::Process").c_str(), active, block_size, t, "sample");
+      Record((name + "::Process").c_str(), active, block_size, t / active,
+             "mode_sample");
+    }
+
+    for (bool fast : {true, false}) {
+      string.set_fast_update(fast);
+      Record((name + (fast ? "::set_freq(fast)" : "::set_freq")).c_str(),
+             num_modes, 0, TimePerOp([](long n) {
+               for (long i = 0; i < n; ++i) string.set_freq(20.0f + (i & 63));
+             }), "call");
+    }
+    Record((name + "::SetInitialAmplitudes").c_str(), num_modes, 0,
+           TimePerOp([](long n) {
+             for (long i = 0; i < n; ++i) string.SetInitialAmplitudes();
+           }), "call");
+  }
+}
+
+// Rendering of a string with two pickups (one pass over the modes for both
+// channels), to compare with StiffString::Process for one
+void BenchStereo(const std::vector<int> &mode_counts,
+                 const std::vector<int> &block_sizes) {
+  static StiffString string;
+  alignas(SIMD_ALIGN) static char memory[
+      StiffString::StorageBytes(MAX_NUM_MODES, 2)];
+  static float left[1024], right[1024];
+  static float *const out[2] = {left, right};
+  LEAF *leaf = LEAF_init(48000.0f, memory, sizeof(memory), nullptr);
+  mpool_create_arena(memory, sizeof(memory), leaf->mempool);
+  string.Init(48000.0f,
+              *std::max_element(mode_counts.begin(), mode_counts.end()),
+              leaf->mempool, 2);
+  for (int num_modes : mode_counts) {
+    string.Init(48000.0f, num_modes, leaf->mempool, 2);
+    string.set_pickup_pos(0, 0.2f);
+    string.set_pickup_pos(1, 0.3f);
+    string.set_decay(0.0f);
+    string.set_decay_high_freq(0.0f);
+    string.set_freq(20.0f);
+    string.SetInitialAmplitudes();
+    int active = string.num_active_modes();
+    for (int block_size : block_sizes) {
+      double t = TimePerOp([=](long n) {
+        for (long i = 0; i < n; ++i) string.Process(out, block_size);
+        sink = left[0] + right[0];
+      }) / block_size;
+      Record("StiffString(stereo)::Process", active, block_size, t,
+             "sample");
+      Record("StiffString(stereo)::Process", active, block_size, t / active,
+             "mode_sample");
+    }
+  }
+}
+
+// Rendering of a string driven by an input signal (see StiffString.h), to
+// compare with StiffString::Process without one
+void BenchInput(const std::vector<int> &mode_counts,
+                const std::vector<int> &block_sizes) {
+  static StiffString string;
+  alignas(SIMD_ALIGN) static char memory[
+      StiffString::StorageBytes(MAX_NUM_MODES)];
+  static float in[1024], buf[1024];
+  LEAF *leaf = LEAF_init(48000.0f, memory, sizeof(memory), nullptr);
+  mpool_create_arena(memory, sizeof(memory), leaf->mempool);
+  string.Init(48000.0f,
+              *std::max_element(mode_counts.begin(), mode_counts.end()),
+              leaf->mempool);
+  for (size_t j = 0; j < 1024; ++j) {
+    in[j] = (j % 97) / 97.0f - 0.5f;
+  }
+  for (int num_modes : mode_counts) {
+    string.Init(48000.0f, num_modes, leaf->mempool);
+    string.set_decay(0.0f);
+    string.set_decay_high_freq(0.0f);
+    string.set_freq(20.0f);
+    string.set_input_gain(0.5f);
+    string.SetInitialAmplitudes();
+    int active = string.num_active_modes();
+    for (int block_size : block_sizes) {
+      double t = TimePerOp([=](long n) {
+        for (long i = 0; i < n; ++i) string.Process(in, buf, block_size);
+        sink = buf[0];
+      }) / block_size;
+      Record("StiffString(input)::Process", active, block_size, t, "sample");
+      Record("StiffString(input)::Process", active, block_size, t / active,
+             "mode_sample");
+    }
+  }
+}
+
+// Rendering of a plucked string (with the default decays) over the second
+// after it has sounded for a while, as its modes die away and stop being
+// rendered (see DampedOscillatorBank.h).  The modes column is the number
+// still rendered at the start of that second (after at least one block,
+// which picks up the pluck).  The best of a few runs, as
+// each depends on the time since the pluck, which TimePerOp() can't hold.
+void BenchDecayed(const std::vector<int> &mode_counts,
+                  const std::vector<int> &block_sizes) {
+  static StiffString string;
+  alignas(SIMD_ALIGN) static char memory[
+      StiffString::StorageBytes(MAX_NUM_MODES)];
+  static float buf[1024];
+  LEAF *leaf = LEAF_init(48000.0f, memory, sizeof(memory), nullptr);
+  mpool_create_arena(memory, sizeof(memory), leaf->mempool);
+  string.Init(48000.0f,
+              *std::max_element(mode_counts.begin(), mode_counts.end()),
+              leaf->mempool);
+  const float seconds[] = {0.0f, 0.5f, 4.0f};
+  for (int num_modes : mode_counts) {
+    string.Init(48000.0f, num_modes, leaf->mempool);
+    string.set_freq(110.0f);
+    for (float s : seconds) {
+      std::string name = "StiffString(after " + std::to_string(s).substr(0, 3) +
+                         " s)::Process";
+      for (int block_size : block_sizes) {
+        using Clock = std::chrono::steady_clock;
+        const long kSamples = 48000;
+        double best = 0.0;
+        int live = 0;
+        for (int run = 0; run < 3; ++run) {
+          string.SetInitialAmplitudes();
+          for (long j = 0; j <= s * 48000.0f; j += 64) {
+            string.Process(buf, 64);
+          }
+          live = string.bank()->num_live();
+          auto start = Clock::now();
+          for (long j = 0; j < kSamples; j += block_size) {
+            string.Process(buf, block_size);
+          }
+          sink = buf[0];
+          std::chrono::duration<double, std::nano> t = Clock::now() - start;
+          if (run == 0 || t.count() < best) {
+            best = t.count();
+          }
+        }
+        Record(name.c_str(), live, block_size, best / kSamples, "sample");
+      }
+    }
+  }
+}
+
+// Six coupled strings of num_modes modes in a StringBank, against six
+// separate StiffStrings; the time is per sample of the whole set.
+void BenchStringBank(const std::vector<int> &mode_counts,
+                     const std::vector<int> &block_sizes) {
+  const int kNumStrings = 6;
+  const float kFreqs[kNumStrings] = {20.0f, 27.0f, 36.0f, 48.0f, 60.0f, 80.0f};
+  static StringBank bank;
+  static StiffString strings[kNumStrings];
+  alignas(SIMD_ALIGN) static char memory[
+      StringBank::StorageBytes(kNumStrings, MAX_NUM_MODES) +
+      kNumStrings * StiffString::StorageBytes(MAX_NUM_MODES)];
+  static float buf[1024];
+  LEAF *leaf = LEAF_init(48000.0f, memory, sizeof(memory), nullptr);
+  mpool_create_arena(memory, sizeof(memory), leaf->mempool);
+  int max_modes = *std::max_element(mode_counts.begin(), mode_counts.end());
+  bank.Init(48000.0f, kNumStrings, max_modes, leaf->mempool);
+  for (StiffString &string : strings) {
+    string.Init(48000.0f, max_modes, leaf->mempool);
+  }
+  for (int num_modes : mode_counts) {
+    bank.Init(48000.0f, kNumStrings, num_modes, leaf->mempool);
+    for (int s = 0; s < kNumStrings; ++s) {
+      BankString &string = bank.string(s);
+      string.set_decay(0.0f);
+      string.set_decay_high_freq(0.0f);
+      string.set_freq(kFreqs[s]);
+      string.SetInitialAmplitudes();
+      strings[s].Init(48000.0f, num_modes, leaf->mempool);
+      strings[s].set_decay(0.0f);
+      strings[s].set_decay_high_freq(0.0f);
+      strings[s].set_freq(kFreqs[s]);
+      strings[s].SetInitialAmplitudes();
+    }
+    int active = kNumStrings * num_modes;
+    for (int block_size : block_sizes) {
+      double t = TimePerOp([=](long n) {
+        for (long i = 0; i < n; ++i) bank.Process(buf, block_size);
+        sink = buf[0];
+      }) / block_size;
+      Record("StringBank::Process", active, block_size, t, "sample");
+      Record("StringBank::Process", active, block_size, t / active,
+             "mode_sample");
+      t = TimePerOp([=](long n) {
+        for (long i = 0; i < n; ++i) {
+          for (StiffString &string : strings) {
+            string.Process(buf, block_size);
+          }
+        }
+        sink = buf[0];
+      }) / block_size;
+      Record("StiffString[6]::Process", active, block_size, t, "sample");
+      Record("StiffString[6]::Process", active, block_size, t / active,
+             "mode_sample");
+    }
+  }
+}
+
+// Mean, 99.9th percentile and worst-case time of a series of calls.  On a
+// desktop OS the maximum includes preemption, so the percentile is the more
+// repeatable measure of an allocator's worst case.
+struct Latency {
+  std::vector<double> ns;
+
+  void Add(std::chrono::steady_clock::duration d) {
+    ns.push_back(std::chrono::duration<double, std::nano>(d).count());
+  }
+
+  // Record benchmark (the mean), benchmark:p999 and benchmark:max
+  void Report(const std::string &benchmark, int modes) {
+    if (ns.empty()) {
+      return;
+    }
+    std::sort(ns.begin(), ns.end());
+    double total = 0.0;
+    for (double t : ns) total += t;
+    Record(benchmark.c_str(), modes, 0, total / ns.size(), "call");
+    Record((benchmark + ":p999").c_str(), modes, 0,
+           ns[ns.size() * 999 / 1000], "call");
+    Record((benchmark + ":max").c_str(), modes, 0, ns.back(), "call");
+  }
+};
+
+const MempoolType pool_types[] = {MempoolFirstFit, MempoolTLSF};
+
+void CreatePool(MempoolType type, void *memory, size_t size, tMempool *pool) {
+  if (type == MempoolTLSF) {
+    mpool_create_tlsf(memory, size, pool);
+  } else {
+    mpool_create(memory, size, pool);
+  }
+}
+
+// Benchmark names for TLSF pools start with "tlsf:"
+std::string PoolName(MempoolType type, const char *name) {
+  return std::string(type == MempoolTLSF ? "tlsf:" : "") + name;
+}
+
+// Allocation and free from a pool whose free list has been fragmented into
+// about num_fragments small blocks, for a request that fits the first free
+// block (small) and one that fits none of the fragments (large).  Reports
+// the mean and worst-case time per call.
+void BenchMempool(const std::vector<int> &fragment_counts) {
+  alignas(SIMD_ALIGN) static char memory[1 << 22];
+  memset(memory, 0, sizeof(memory));  // page faults are not the pool's doing
+  LEAF *leaf = LEAF_init(48000.0f, memory, sizeof(memory), nullptr);
+  for (MempoolType type : pool_types) {
+    for (int num_fragments : fragment_counts) {
+      static tMempool pool;
+      pool.leaf = leaf;
+      CreatePool(type, memory, sizeof(memory), &pool);
+      // allocate 2 * num_fragments blocks and free every other one, so that
+      // no two free blocks are adjacent
+      std::vector<void *> blocks;
+      srand(1);
+      for (int i = 0; i < 2 * num_fragments; ++i) {
+        blocks.push_back(mpool_alloc(16 + 8 * (rand() % 16), &pool));
+      }
+      for (int i = 0; i < 2 * num_fragments; i += 2) {
+        mpool_free(blocks[i], &pool);
+      }
+      const int sizes[] = {16, 1024};
+      for (int size : sizes) {
+        const int num_calls = 2000;
+        using Clock = std::chrono::steady_clock;
+        Latency alloc, free;
+        for (int i = 0; i < num_calls; ++i) {
+          auto t0 = Clock::now();
+          void *p = mpool_alloc(size, &pool);
+          auto t1 = Clock::now();
+          mpool_free(p, &pool);
+          auto t2 = Clock::now();
+          alloc.Add(t1 - t0);
+          free.Add(t2 - t1);
+        }
+        char name[64];
+        snprintf(name, sizeof(name), "mpool_alloc(%d)", size);
+        alloc.Report(PoolName(type, name), num_fragments);
+        snprintf(name, sizeof(name), "mpool_free(%d)", size);
+        free.Report(PoolName(type, name), num_fragments);
+      }
+    }
+  }
+}
+
+// Random churn, as when voices and effects are created and destroyed while
+// audio runs: with up to max_live blocks of 16 bytes to 16 kB live at a
+// time, allocate or free a random block, num_ops times.  Reports the mean
+// and worst-case time per call; the worst case is what matters in an audio
+// callback.
+void BenchMempoolStress(const std::vector<int> &live_counts, int num_ops) {
+  alignas(SIMD_ALIGN) static char memory[1 << 24];
+  memset(memory, 0, sizeof(memory));  // page faults are not the pool's doing
+  LEAF *leaf = LEAF_init(48000.0f, memory, sizeof(memory), nullptr);
+  for (MempoolType type : pool_types) {
+    for (int max_live : live_counts) {
+      static tMempool pool;
+      pool.leaf = leaf;
+      CreatePool(type, memory, sizeof(memory), &pool);
+      using Clock = std::chrono::steady_clock;
+      Latency alloc, free;
+      std::vector<void *> live;
+      srand(2);
+      for (int i = 0; i < num_ops; ++i) {
+        if (live.empty() || (static_cast<int>(live.size()) < max_live
+                             && rand() % 2 == 0)) {
+          // mostly small blocks, with the occasional large one
+          size_t size = 16 << (rand() % 4 == 0 ? rand() % 11 : rand() % 4);
+          auto t0 = Clock::now();
+          void *p = mpool_alloc(size, &pool);
+          alloc.Add(Clock::now() - t0);
+          if (p != nullptr) {
+            live.push_back(p);
+          }
+        } else {
+          size_t k = rand() % live.size();
+          auto t0 = Clock::now();
+          mpool_free(live[k], &pool);
+          free.Add(Clock::now() - t0);
+          live[k] = live.back();
+          live.pop_back();
+        }
+      }
+      alloc.Report(PoolName(type, "mpool_stress_alloc"), max_live);
+      free.Report(PoolName(type, "mpool_stress_free"), max_live);
+    }
+  }
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  bool quick = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "jq")) != -1) {
+    switch (opt) {
+      case 'j': json = true; break;
+      case 'q': quick = true; break;
+      default:
+        fprintf(stderr, "usage: bench [-j] [-q]\n");
+        return 1;
+    }
+  }
+  // as in StringSynth::Process: keep subnormal numbers from skewing the
+  // timings
+  ScopedFlushToZero flush_to_zero;
+  std::vector<int> mode_counts = {1, 4, 16, 32, 60, 128, 256, MAX_NUM_MODES};
+  std::vector<int> block_sizes = {1, 4, 16, 64, 256};
+  std::vector<int> fragment_counts = {10, 100, 1000, 10000};
+  std::vector<int> live_counts = {100, 1000, 10000};
+  int num_stress_ops = 200000;
+  if (quick) {
+    min_time = 0.002;
+    mode_counts = {1, 16, 32, 60, 128, MAX_NUM_MODES};
+    block_sizes = {4, 64};
+    fragment_counts = {10, 1000};
+    live_counts = {100, 1000};
+    num_stress_ops = 20000;
+  }
+
+  BenchPrimitives();
+  BenchStiffString<StiffString>("StiffString", mode_counts, block_sizes);
+  BenchStiffString<CycleStiffString>("CycleStiffString", mode_counts,
+                                     block_sizes);
+  BenchStiffString<FixedStiffString>("FixedStiffString", mode_counts,
+                                     block_sizes);
+  BenchStereo(mode_counts, block_sizes);
+  BenchInput(mode_counts, block_sizes);
+  BenchDecayed(mode_counts, block_sizes);
+  BenchStringBank(mode_counts, block_sizes);
+  // compile-time mode counts, against StiffString with the same counts
+  BenchStiffString<StaticStiffString<16>>("StaticStiffString", {16},
+                                          block_sizes);
+  BenchStiffString<StaticStiffString<32>>("StaticStiffString", {32},
+                                          block_sizes);
+  BenchStiffString<StaticStiffString<60>>("StaticStiffString", {60},
+                                          block_sizes);
+  BenchStiffString<StaticStiffString<128>>("StaticStiffString", {128},
+                                           block_sizes);
+  BenchMempool(fragment_counts);
+  BenchMempoolStress(live_counts, num_stress_ops);
+  if (json) {
+    printf("\n]\n");
+  }
+  return 0;
+}
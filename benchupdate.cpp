@@ -0,0 +1,120 @@
+/*
+  Cost of one StiffString::UpdateOscillators() pass (run by set_freq,
+  set_decay and set_decay_high_freq), with libm and with the fast path, and
+  of a pluck (SetAmplitudes) and a pickup move, with and without a
+  SpectrumCache, and of tuning a string for a note-on, with set_freq and
+  set_decay and from a NoteTable.
+
+  Build on the host with
+    g++ -O2 -std=c++14 benchupdate.cpp StiffString.cpp CycleBank.cpp \
+      DampedOscillatorBank.cpp FixedOscillatorBank.cpp BankSlice.cpp \
+      StringBank.cpp SpectrumCache.cpp NoteTable.cpp leaflet.c
+*/
+
+#include <stdio.h>
+#include <chrono>
+#include "NoteTable.h"
+#include "StiffString.h"
+#include "leaflet.h"
+
+static StiffString string;
+static SpectrumCache cache;
+static NoteTable table;
+alignas(SIMD_ALIGN) static char memory[
+    StiffString::StorageBytes(MAX_NUM_MODES) +
+    SpectrumCache::StorageBytes(MAX_NUM_MODES)];
+static tMempool table_pool;
+alignas(SIMD_ALIGN) static char table_memory[
+    NoteTable::StorageBytes(MAX_NUM_MODES)];
+
+double TimeUpdate(bool fast, int num_updates) {
+  string.set_fast_update(fast);
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_updates; ++i) {
+    string.set_freq(20.0f + (i & 63));
+  }
+  auto end = std::chrono::steady_clock::now();
+  std::chrono::duration<double, std::micro> elapsed = end - start;
+  return elapsed.count() / num_updates;
+}
+
+// Pluck (or move the pickup) at positions on the cache's rows, or between
+// them
+double TimeSpectrum(bool pickup, bool on_rows, int num_updates) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_updates; ++i) {
+    float pos = ((i & 63) + (on_rows ? 32 : 32.3f)) / 127.0f;
+    if (pickup) {
+      string.set_pickup_pos(pos);
+    } else {
+      string.set_pluck_pos(pos);
+      string.SetAmplitudes();
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  std::chrono::duration<double, std::micro> elapsed = end - start;
+  return elapsed.count() / num_updates;
+}
+
+// Tune the string to a note as StringSynth::NoteOn() does
+double TimeNoteOn(bool use_table, int num_updates) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_updates; ++i) {
+    int note = 36 + (i & 63);
+    if (!use_table || !table.Tune(note, &string)) {
+      string.set_freq(midi_to_freq(note));
+      string.set_decay(0.0f);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  std::chrono::duration<double, std::micro> elapsed = end - start;
+  return elapsed.count() / num_updates;
+}
+
+int main() {
+  const int num_updates = 2000;
+  const int mode_counts[] = {16, 60, 128, 400};
+  // Storage for the most modes, so the loop below never reallocates
+  LEAF *leaf = LEAF_init(48000.0f, memory, sizeof(memory), nullptr);
+  mpool_create_arena(memory, sizeof(memory), leaf->mempool);
+  string.Init(48000.0f, MAX_NUM_MODES, leaf->mempool);
+  string.set_stiffness(0.01f);
+  printf("modes,libm_us,fast_us,speedup\n");
+  for (int num_modes : mode_counts) {
+    string.Init(48000.0f, num_modes, leaf->mempool);
+    double libm = TimeUpdate(false, num_updates);
+    double fast = TimeUpdate(true, num_updates);
+    printf("%d,%.3f,%.3f,%.2f\n", num_modes, libm, fast, libm / fast);
+  }
+
+  // Rows at k / 127, as for a controller from 0 to 1
+  cache.Init(MAX_NUM_MODES, 0.0f, 1.0f, leaf->mempool);
+  printf("\nmodes,update,libm_us,cached_us,between_rows_us\n");
+  for (int num_modes : mode_counts) {
+    string.Init(48000.0f, num_modes, leaf->mempool);
+    for (int pickup = 0; pickup < 2; ++pickup) {
+      string.set_spectrum_cache(nullptr);
+      double libm = TimeSpectrum(pickup, true, num_updates);
+      string.set_spectrum_cache(&cache);
+      double cached = TimeSpectrum(pickup, true, num_updates);
+      double between = TimeSpectrum(pickup, false, num_updates);
+      printf("%d,%s,%.3f,%.3f,%.3f\n", num_modes,
+             pickup ? "pickup" : "pluck", libm, cached, between);
+    }
+  }
+
+  printf("\nmodes,set_freq_decay_us,note_table_us\n");
+  table_pool.leaf = leaf;
+  mpool_create_arena(table_memory, sizeof(table_memory), &table_pool);
+  for (int num_modes : mode_counts) {
+    // The arena never frees, so start it afresh for each table
+    mpool_reset(&table_pool);
+    string.Init(48000.0f, num_modes, leaf->mempool);
+    table.Init(48000.0f, num_modes, &table_pool);
+    table.Update(NoteTable::kNumNotes);
+    double direct = TimeNoteOn(false, num_updates);
+    double tabled = TimeNoteOn(true, num_updates);
+    printf("%d,%.3f,%.3f\n", num_modes, direct, tabled);
+  }
+  return 0;
+}
@@ -1,5 +1,6 @@
 #include "leaflet.h"
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 #ifdef __cplusplus
@@ -22,6 +23,7 @@ LEAF *LEAF_init(Lfloat sr, void *memory, size_t memorysize, Lfloat(*random)(void
     leaf->errorState[i] = 0;
   leaf->allocCount = 0;
   leaf->freeCount = 0;
+  leaf->clock = NULL;
   return leaf;
 }
 
@@ -42,6 +44,12 @@ void LEAF_internalErrorCallback(LEAF* const leaf, LEAFErrorType whichone) {
 static inline size_t mpool_align(size_t size);
 static inline mpool_node_t* create_node(void* block_location, mpool_node_t* next, mpool_node_t* prev, size_t size, size_t header_size);
 static inline void delink_node(mpool_node_t* node);
+static void* first_fit_alloc(size_t asize, tMempool* pool);
+static void first_fit_free(void* ptr, tMempool* pool);
+static void* tlsf_alloc(size_t asize, tMempool* pool);
+static void tlsf_free(void* ptr, tMempool* pool);
+static void* arena_alloc(size_t asize, tMempool* pool);
+static void tlsf_init(tMempool* pool);
 
 /**
  * allocate memory from memory pool
@@ -63,6 +71,31 @@ void* mpool_alloc(size_t asize, tMempool *pool) {
   }
   return temp;
 #else
+  uint32_t start = (pool->leaf->clock != NULL) ? pool->leaf->clock() : 0;
+  void* ptr;
+  if (pool->type == MempoolTLSF) {
+    ptr = tlsf_alloc(asize, pool);
+  } else if (pool->type == MempoolArena) {
+    ptr = arena_alloc(asize, pool);
+  } else {
+    ptr = first_fit_alloc(asize, pool);
+  }
+  if (pool->leaf->clock != NULL) {
+    uint32_t elapsed = pool->leaf->clock() - start;
+    pool->allocTime += elapsed;
+    if (elapsed > pool->allocTimeMax) pool->allocTimeMax = elapsed;
+  }
+  if (ptr == NULL) {
+    pool->failCount++;
+  } else {
+    pool->allocCount++;
+    if (pool->usize > pool->highWater) pool->highWater = pool->usize;
+  }
+  return ptr;
+#endif
+}
+
+static void* first_fit_alloc(size_t asize, tMempool* pool) {
   // If the head is NULL, the mempool is full
   if (pool->head == NULL) {
     if ((pool->msize - pool->usize) > asize) {
@@ -106,6 +139,11 @@ void* mpool_alloc(size_t asize, tMempool *pool) {
                            node_to_alloc->next,
                            node_to_alloc->prev,
                            leftover - pool->leaf->header_size, pool->leaf->header_size);
+    // The new node takes the allocated node's place in the free list
+    if (new_node->next != NULL) new_node->next->prev = new_node;
+    if (new_node->prev != NULL) new_node->prev->next = new_node;
+    node_to_alloc->next = NULL;
+    node_to_alloc->prev = NULL;
   }
   else {
     // Add any leftover space to the allocated node to avoid fragmentation
@@ -133,7 +171,6 @@ void* mpool_alloc(size_t asize, tMempool *pool) {
     
   // Return the pool of the allocated node;
   return node_to_alloc->pool;
-#endif
 }
 
 void mpool_free(void *ptr, tMempool *pool) {
@@ -144,6 +181,22 @@ void mpool_free(void *ptr, tMempool *pool) {
 #if LEAF_USE_DYNAMIC_ALLOCATION
   free(ptr);
 #else
+  uint32_t start = (pool->leaf->clock != NULL) ? pool->leaf->clock() : 0;
+  if (pool->type == MempoolTLSF) {
+    tlsf_free(ptr, pool);
+  } else if (pool->type != MempoolArena) {
+    first_fit_free(ptr, pool);
+  }
+  if (pool->leaf->clock != NULL) {
+    uint32_t elapsed = pool->leaf->clock() - start;
+    pool->freeTime += elapsed;
+    if (elapsed > pool->freeTimeMax) pool->freeTimeMax = elapsed;
+  }
+  pool->freeCount++;
+#endif
+}
+
+static void first_fit_free(void* ptr, tMempool* pool) {
   //if (ptr < pool->mpool || ptr >= pool->mpool + pool->msize)
   // Get the node at the freed space
   mpool_node_t* freed_node = (mpool_node_t*) (ptr - pool->leaf->header_size);
@@ -202,7 +255,6 @@ void mpool_free(void *ptr, tMempool *pool) {
   // Format the freed pool
   //    char* freed_pool = (char*)freed_node->pool;
   //    for (int i = 0; i < freed_node->size; i++) freed_pool[i] = 0;
-#endif
 }
 
 /**
@@ -211,14 +263,359 @@ void mpool_free(void *ptr, tMempool *pool) {
 void mpool_create (void* memory, size_t size, tMempool* pool) {
   pool->leaf->header_size = mpool_align(sizeof(mpool_node_t));
     
+  pool->type = MempoolFirstFit;
   pool->mpool = (char*)memory;
-  pool->usize  = 0;
   if (size < pool->leaf->header_size) {
     size = pool->leaf->header_size;
   }
   pool->msize  = size;
-    
-  pool->head = create_node(pool->mpool, NULL, NULL, pool->msize - pool->leaf->header_size, pool->leaf->header_size);
+  mpool_reset(pool);
+  mpool_reset_stats(pool);
+}
+
+void mpool_create_arena(void* memory, size_t size, tMempool* pool) {
+  pool->type = MempoolArena;
+  pool->mpool = (char*) memory;
+  pool->msize = size;
+  mpool_reset(pool);
+  mpool_reset_stats(pool);
+}
+
+void mpool_reset(tMempool* pool) {
+  if (pool->type == MempoolTLSF) {
+    tlsf_init(pool);
+    return;
+  }
+  pool->tlsf = NULL;
+  pool->usize = 0;
+  if (pool->type == MempoolArena) {
+    pool->head = NULL;
+  } else {
+    pool->head = create_node(pool->mpool, NULL, NULL, pool->msize - pool->leaf->header_size, pool->leaf->header_size);
+  }
+}
+
+// The arena's used size is the offset of its first free byte
+static void* arena_alloc(size_t asize, tMempool* pool) {
+  size_t offset = mpool_align(pool->usize);
+  if (offset > pool->msize || asize > pool->msize - offset) {
+    LEAF_internalErrorCallback(pool->leaf, LEAFMempoolOverrun);
+    return NULL;
+  }
+  pool->usize = offset + asize;
+  void* ptr = (char*) pool->mpool + offset;
+  if (pool->leaf->clearOnAllocation > 0) {
+    memset(ptr, 0, asize);
+  }
+  return ptr;
+}
+
+void* mpool_calloc(size_t asize, tMempool* pool) {
+  void* ptr = mpool_alloc(asize, pool);
+  if (ptr != NULL) {
+    memset(ptr, 0, asize);
+  }
+  return ptr;
+}
+
+size_t mpool_get_size(tMempool* pool) {
+  return pool->msize;
+}
+
+size_t mpool_get_used(tMempool* pool) {
+  return pool->usize;
+}
+
+void* leaf_alloc(LEAF* const leaf, size_t size) {
+  return mpool_alloc(size, leaf->mempool);
+}
+
+void* leaf_calloc(LEAF* const leaf, size_t size) {
+  return mpool_calloc(size, leaf->mempool);
+}
+
+void leaf_free(LEAF* const leaf, void* ptr) {
+  mpool_free(ptr, leaf->mempool);
+}
+
+size_t leaf_pool_get_size(LEAF* const leaf) {
+  return mpool_get_size(leaf->mempool);
+}
+
+size_t leaf_pool_get_used(LEAF* const leaf) {
+  return mpool_get_used(leaf->mempool);
+}
+
+void* leaf_pool_get_pool(LEAF* const leaf) {
+  return leaf->mempool->mpool;
+}
+
+//==============================================================================
+// TLSF pools (after Masmano et al., "TLSF: a new dynamic memory allocator
+// for real-time systems").  Free blocks are kept in one list per size
+// class: sizes below 2^MPOOL_TLSF_FL_SHIFT are split linearly, and each
+// larger power of two is split into MPOOL_TLSF_SL_COUNT classes.  Two
+// levels of bitmaps record which lists are non-empty, so that alloc finds
+// a large enough block with two find-first-set operations, and free
+// merges with its physical neighbours through the prev_phys links, without
+// any list walk.  The pool ends with a zero-size used block, so that every
+// real block has a physical successor.
+
+#define TLSF_FREE_BIT ((size_t) 1)
+#define TLSF_SMALL_SIZE ((size_t) 1 << MPOOL_TLSF_FL_SHIFT)
+
+static inline size_t tlsf_header_size(void) {
+  return mpool_align(sizeof(mpool_block_t));
+}
+
+static inline size_t tlsf_size(mpool_block_t* block) {
+  return block->size & ~TLSF_FREE_BIT;
+}
+
+static inline int tlsf_is_free(mpool_block_t* block) {
+  return (block->size & TLSF_FREE_BIT) != 0;
+}
+
+static inline mpool_block_t* tlsf_next_phys(mpool_block_t* block) {
+  return (mpool_block_t*) ((char*) block + tlsf_header_size()
+                           + tlsf_size(block));
+}
+
+// index of the most significant set bit
+static inline int tlsf_fls(size_t x) {
+  return (int) (8 * sizeof(unsigned long)) - 1 - __builtin_clzl(x);
+}
+
+// size class (fl, sl) that a free block of the given size belongs to
+static inline void tlsf_mapping_insert(size_t size, int* fl, int* sl) {
+  if (size < TLSF_SMALL_SIZE) {
+    *fl = 0;
+    *sl = (int) (size / (TLSF_SMALL_SIZE / MPOOL_TLSF_SL_COUNT));
+  } else {
+    int f = tlsf_fls(size);
+    *sl = (int) (size >> (f - MPOOL_TLSF_SL_LOG2)) ^ MPOOL_TLSF_SL_COUNT;
+    *fl = f - (MPOOL_TLSF_FL_SHIFT - 1);
+  }
+}
+
+// first size class whose blocks are all at least size bytes
+static inline void tlsf_mapping_search(size_t size, int* fl, int* sl) {
+  if (size >= TLSF_SMALL_SIZE) {
+    size += ((size_t) 1 << (tlsf_fls(size) - MPOOL_TLSF_SL_LOG2)) - 1;
+  }
+  tlsf_mapping_insert(size, fl, sl);
+}
+
+static inline void tlsf_insert(mpool_tlsf_t* tlsf, mpool_block_t* block) {
+  int fl, sl;
+  tlsf_mapping_insert(tlsf_size(block), &fl, &sl);
+  mpool_block_t* head = tlsf->blocks[fl][sl];
+  block->next_free = head;
+  block->prev_free = NULL;
+  if (head != NULL) head->prev_free = block;
+  tlsf->blocks[fl][sl] = block;
+  tlsf->fl_bitmap |= 1U << fl;
+  tlsf->sl_bitmap[fl] |= 1U << sl;
+}
+
+static inline void tlsf_remove(mpool_tlsf_t* tlsf, mpool_block_t* block) {
+  int fl, sl;
+  tlsf_mapping_insert(tlsf_size(block), &fl, &sl);
+  if (block->next_free != NULL) block->next_free->prev_free = block->prev_free;
+  if (block->prev_free != NULL) {
+    block->prev_free->next_free = block->next_free;
+  } else {
+    tlsf->blocks[fl][sl] = block->next_free;
+    if (block->next_free == NULL) {
+      tlsf->sl_bitmap[fl] &= ~(1U << sl);
+      if (tlsf->sl_bitmap[fl] == 0) tlsf->fl_bitmap &= ~(1U << fl);
+    }
+  }
+}
+
+// a free block of at least size bytes, or NULL if there is none
+static inline mpool_block_t* tlsf_find(mpool_tlsf_t* tlsf, size_t size) {
+  int fl, sl;
+  tlsf_mapping_search(size, &fl, &sl);
+  if (fl >= MPOOL_TLSF_FL_COUNT) return NULL;
+  unsigned int sl_map = tlsf->sl_bitmap[fl] & (~0U << sl);
+  if (sl_map == 0) {
+    unsigned int fl_map = tlsf->fl_bitmap & (~0U << (fl + 1));
+    if (fl_map == 0) return NULL;
+    fl = __builtin_ctz(fl_map);
+    sl_map = tlsf->sl_bitmap[fl];
+  }
+  sl = __builtin_ctz(sl_map);
+  return tlsf->blocks[fl][sl];
+}
+
+void mpool_create_tlsf(void* memory, size_t size, tMempool* pool) {
+  size_t min_size = mpool_align(sizeof(mpool_tlsf_t)) + 3 * tlsf_header_size();
+  pool->type = MempoolTLSF;
+  pool->mpool = (char*) memory;
+  pool->msize = size < min_size ? min_size : size;
+  mpool_reset(pool);
+  mpool_reset_stats(pool);
+}
+
+// Format the pool memory as one free block, followed by the end sentinel
+static void tlsf_init(tMempool* pool) {
+  size_t header_size = tlsf_header_size();
+  size_t control_size = mpool_align(sizeof(mpool_tlsf_t));
+  pool->head = NULL;
+  // the control structure and the end sentinel count as used
+  pool->usize = control_size + header_size;
+
+  mpool_tlsf_t* tlsf = (mpool_tlsf_t*) pool->mpool;
+  memset(tlsf, 0, sizeof(mpool_tlsf_t));
+  pool->tlsf = tlsf;
+
+  size_t max_size = ((size_t) 1 << MPOOL_TLSF_FL_MAX) - MPOOL_ALIGN_SIZE;
+  size_t block_size = (pool->msize - control_size - 2 * header_size)
+                      & ~(MPOOL_ALIGN_SIZE - 1);
+  if (block_size > max_size) block_size = max_size;
+  mpool_block_t* block = (mpool_block_t*) ((char*) pool->mpool + control_size);
+  block->prev_phys = NULL;
+  block->size = block_size | TLSF_FREE_BIT;
+  tlsf_insert(tlsf, block);
+
+  mpool_block_t* sentinel = tlsf_next_phys(block);
+  sentinel->prev_phys = block;
+  sentinel->size = 0;
+}
+
+static void* tlsf_alloc(size_t asize, tMempool* pool) {
+  mpool_tlsf_t* tlsf = pool->tlsf;
+  size_t header_size = tlsf_header_size();
+  size_t size = mpool_align(asize);
+  if (size < MPOOL_ALIGN_SIZE) size = MPOOL_ALIGN_SIZE;
+
+  mpool_block_t* block = tlsf_find(tlsf, size);
+  if (block == NULL) {
+    if ((pool->msize - pool->usize) > asize) {
+      LEAF_internalErrorCallback(pool->leaf, LEAFMempoolFragmentation);
+    }
+    else {
+      LEAF_internalErrorCallback(pool->leaf, LEAFMempoolOverrun);
+    }
+    return NULL;
+  }
+  tlsf_remove(tlsf, block);
+
+  // Split off the remainder as a new free block, if it is big enough
+  size_t block_size = tlsf_size(block);
+  if (block_size >= size + header_size + MPOOL_ALIGN_SIZE) {
+    mpool_block_t* rest = (mpool_block_t*) ((char*) block + header_size + size);
+    rest->prev_phys = block;
+    rest->size = (block_size - size - header_size) | TLSF_FREE_BIT;
+    tlsf_next_phys(rest)->prev_phys = rest;
+    tlsf_insert(tlsf, rest);
+    block_size = size;
+  }
+  block->size = block_size;
+  pool->usize += header_size + block_size;
+
+  void* ptr = (char*) block + header_size;
+  if (pool->leaf->clearOnAllocation > 0) {
+    memset(ptr, 0, block_size);
+  }
+  return ptr;
+}
+
+static void tlsf_free(void* ptr, tMempool* pool) {
+  mpool_tlsf_t* tlsf = pool->tlsf;
+  size_t header_size = tlsf_header_size();
+  mpool_block_t* block = (mpool_block_t*) ((char*) ptr - header_size);
+  char* first = (char*) pool->mpool + mpool_align(sizeof(mpool_tlsf_t))
+                + header_size;
+  if ((char*) ptr < first || (char*) ptr >= (char*) pool->mpool + pool->msize
+      || tlsf_is_free(block) || tlsf_size(block) == 0) {
+    LEAF_internalErrorCallback(pool->leaf, LEAFInvalidFree);
+    return;
+  }
+  pool->usize -= header_size + tlsf_size(block);
+
+  // Merge with the free neighbours in memory
+  mpool_block_t* prev = block->prev_phys;
+  if (prev != NULL && tlsf_is_free(prev)) {
+    tlsf_remove(tlsf, prev);
+    prev->size = tlsf_size(prev) + header_size + tlsf_size(block);
+    block = prev;
+  }
+  mpool_block_t* next = tlsf_next_phys(block);
+  if (tlsf_is_free(next)) {
+    tlsf_remove(tlsf, next);
+    block->size = tlsf_size(block) + header_size + tlsf_size(next);
+    next = tlsf_next_phys(block);
+  }
+  next->prev_phys = block;
+  block->size |= TLSF_FREE_BIT;
+  tlsf_insert(tlsf, block);
+}
+
+//==============================================================================
+// Instrumentation
+
+void LEAF_setClock(LEAF* const leaf, uint32_t (*clock)(void)) {
+  leaf->clock = clock;
+}
+
+void mpool_reset_stats(tMempool* pool) {
+  pool->highWater = pool->usize;
+  pool->allocCount = 0;
+  pool->freeCount = 0;
+  pool->failCount = 0;
+  pool->allocTime = 0;
+  pool->allocTimeMax = 0;
+  pool->freeTime = 0;
+  pool->freeTimeMax = 0;
+}
+
+static inline void add_free_block(tMempoolStats* stats, size_t size) {
+  stats->freeBytes += size;
+  stats->numFreeBlocks++;
+  if (size > stats->largestFree) stats->largestFree = size;
+}
+
+// Walks the free lists, so don't call this from the audio callback.
+void mpool_get_stats(tMempool* pool, tMempoolStats* stats) {
+  stats->size = pool->msize;
+  stats->used = pool->usize;
+  stats->highWater = pool->highWater;
+  stats->freeBytes = 0;
+  stats->largestFree = 0;
+  stats->numFreeBlocks = 0;
+  if (pool->type == MempoolTLSF) {
+    for (int fl = 0; fl < MPOOL_TLSF_FL_COUNT; ++fl) {
+      for (int sl = 0; sl < MPOOL_TLSF_SL_COUNT; ++sl) {
+        for (mpool_block_t* block = pool->tlsf->blocks[fl][sl];
+             block != NULL; block = block->next_free) {
+          add_free_block(stats, tlsf_size(block));
+        }
+      }
+    }
+  } else if (pool->type == MempoolArena) {
+    size_t offset = mpool_align(pool->usize);
+    if (offset < pool->msize) {
+      add_free_block(stats, pool->msize - offset);
+    }
+  } else {
+    for (mpool_node_t* node = pool->head; node != NULL; node = node->next) {
+      add_free_block(stats, node->size);
+    }
+  }
+  stats->fragmentation = (stats->freeBytes > 0)
+      ? 1.0f - (Lfloat) stats->largestFree / stats->freeBytes : 0.0f;
+  stats->allocCount = pool->allocCount;
+  stats->freeCount = pool->freeCount;
+  stats->failCount = pool->failCount;
+  unsigned int num_allocs = pool->allocCount + pool->failCount;
+  stats->allocTimeMean = (num_allocs > 0)
+      ? (Lfloat) pool->allocTime / num_allocs : 0.0f;
+  stats->allocTimeMax = pool->allocTimeMax;
+  stats->freeTimeMean = (pool->freeCount > 0)
+      ? (Lfloat) pool->freeTime / pool->freeCount : 0.0f;
+  stats->freeTimeMax = pool->freeTimeMax;
 }
 
 /**
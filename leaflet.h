@@ -1,4 +1,5 @@
 /* tiny subset of the LEAF library, for experimenting with interface */
+#include <stdint.h>
 #include <stdlib.h>
 
 #ifndef LEAFLET_INCLUDED
@@ -15,6 +16,14 @@ typedef float Lfloat;
 #define TWO_TO_32        4294967296.0f
 #define MPOOL_ALIGN_SIZE (8)
 
+// TLSF pools: 2^MPOOL_TLSF_SL_LOG2 size classes per power of two, for
+// blocks of up to 2^MPOOL_TLSF_FL_MAX bytes
+#define MPOOL_TLSF_SL_LOG2 (4)
+#define MPOOL_TLSF_SL_COUNT (1 << MPOOL_TLSF_SL_LOG2)
+#define MPOOL_TLSF_FL_SHIFT (MPOOL_TLSF_SL_LOG2 + 3)
+#define MPOOL_TLSF_FL_MAX (30)
+#define MPOOL_TLSF_FL_COUNT (MPOOL_TLSF_FL_MAX - MPOOL_TLSF_FL_SHIFT + 1)
+
 //! Include wave table required to use tCycle.
 #define LEAF_INCLUDE_SINE_TABLE 1
 #define SINE_TABLE_SIZE 2048
@@ -23,6 +32,8 @@ extern const Lfloat __leaf_table_sinewave[SINE_TABLE_SIZE];
 // leaf-global.h
 
 typedef struct mpool_node_t mpool_node_t;
+typedef struct mpool_block_t mpool_block_t;
+typedef struct mpool_tlsf_t mpool_tlsf_t;
 typedef struct tMempool tMempool;
 typedef struct LEAF LEAF;
 
@@ -34,6 +45,28 @@ struct mpool_node_t {
   size_t size;
 };
 
+// header of a block in a TLSF pool
+struct mpool_block_t {
+  mpool_block_t *prev_phys;  // block just before this one in memory
+  mpool_block_t *next_free;  // free list links, if this block is free
+  mpool_block_t *prev_free;
+  size_t size;               // size of the block; bit 0 is set if free
+};
+
+// TLSF pool control: one free list per size class, and bitmaps of the
+// non-empty lists, so that a fitting block is found in constant time
+struct mpool_tlsf_t {
+  unsigned int fl_bitmap;
+  unsigned int sl_bitmap[MPOOL_TLSF_FL_COUNT];
+  mpool_block_t *blocks[MPOOL_TLSF_FL_COUNT][MPOOL_TLSF_SL_COUNT];
+};
+
+typedef enum MempoolType {
+  MempoolFirstFit = 0,  // single free list, searched first-fit
+  MempoolTLSF,          // two-level segregated fit: O(1) alloc and free
+  MempoolArena          // bump pointer: no headers, free all at once
+} MempoolType;
+
 struct tMempool {
   tMempool      *mempool;
   LEAF*         leaf;
@@ -41,8 +74,37 @@ struct tMempool {
   size_t        usize;       // used size of the pool
   size_t        msize;       // max size of the pool
   mpool_node_t* head;        // first node of memory pool free list
+  MempoolType   type;
+  mpool_tlsf_t* tlsf;        // TLSF control, at the start of the mpool
+  // instrumentation; times are in ticks of the LEAF clock, if it is set
+  size_t        highWater;   // most memory ever used
+  unsigned int  allocCount;
+  unsigned int  freeCount;
+  unsigned int  failCount;   // allocations that returned NULL
+  uint64_t      allocTime;   // total time spent in mpool_alloc
+  uint32_t      allocTimeMax;
+  uint64_t      freeTime;    // total time spent in mpool_free
+  uint32_t      freeTimeMax;
 };
 
+// Snapshot of a pool, filled in by mpool_get_stats
+typedef struct tMempoolStats {
+  size_t       size;          // total size of the pool
+  size_t       used;          // bytes in use, including block headers
+  size_t       highWater;     // most bytes ever in use
+  size_t       freeBytes;     // bytes in free blocks
+  size_t       largestFree;   // largest free block
+  unsigned int numFreeBlocks;
+  Lfloat       fragmentation; // 1 - largestFree / freeBytes (0 = none)
+  unsigned int allocCount;
+  unsigned int freeCount;
+  unsigned int failCount;
+  Lfloat       allocTimeMean; // in clock ticks (0 if no clock is set)
+  uint32_t     allocTimeMax;
+  Lfloat       freeTimeMean;
+  uint32_t     freeTimeMax;
+} tMempoolStats;
+
 typedef enum LEAFErrorType {
   LEAFMempoolOverrun = 0,
   LEAFMempoolFragmentation,
@@ -65,6 +127,7 @@ struct LEAF {
   int     errorState[LEAFErrorNil]; //!< An array of flags that indicate which errors have occurred.
   unsigned int allocCount; //!< A count of LEAF memory allocations.
   unsigned int freeCount; //!< A count of LEAF memory frees.
+  uint32_t (*clock)(void); //!< Clock used to time allocations, or NULL. Set with LEAF_setClock().
   ///@}
 };
 
@@ -76,12 +139,32 @@ Lfloat LEAF_clip(Lfloat min, Lfloat val, Lfloat max);
 LEAF *LEAF_init(Lfloat sampleRate, void *memory, size_t memorySize, Lfloat(*random)(void));
 void LEAF_defaultErrorCallback(LEAF* const leaf, LEAFErrorType errorType);
 void LEAF_internalErrorCallback(LEAF* const leaf, LEAFErrorType whichone);
+// Time every mpool_alloc and mpool_free with clock, a free-running counter
+// such as the DWT cycle counter (NULL to stop timing).
+void LEAF_setClock(LEAF* const leaf, uint32_t (*clock)(void));
 
     
 //==============================================================================
 
 
 void mpool_create(void *memory, size_t size, tMempool *pool);
+// Create a TLSF pool, whose alloc and free take bounded time however
+// fragmented it is.  Requests are rounded up to the next size class (at
+// most 1/16 larger), so an allocation can fail when the only free block
+// that fits is just barely big enough.  The first few kB of memory hold
+// the free lists.  To use one for the LEAF pool, call this on
+// leaf->mempool after LEAF_init().
+void mpool_create_tlsf(void *memory, size_t size, tMempool *pool);
+// Create an arena, for objects that live as long as a patch or voice:
+// allocation just advances a pointer, with no block headers, and
+// mpool_free does nothing.  Memory is reclaimed all at once by mpool_reset.
+void mpool_create_arena(void *memory, size_t size, tMempool *pool);
+// Free everything allocated from a pool of any type.  Statistics are kept.
+void mpool_reset(tMempool *pool);
+
+void mpool_get_stats(tMempool *pool, tMempoolStats *stats);
+// Zero the counters and times, and set the high-water mark to current use
+void mpool_reset_stats(tMempool *pool);
     
 void *mpool_alloc(size_t size, tMempool *pool);
 void *mpool_calloc(size_t asize, tMempool *pool);
@@ -7,91 +7,93 @@
 
 */
 
-#include <math.h>
 #include "daisy_pod.h"
-#include "StiffString.h"
+#include "LoadMeter.h"
+#include "StringSynth.h"
+#include "leaflet.h"
 
 
 daisy::DaisyPod hw;
-StiffString string;
+StringSynth synth;
+LoadMeter load_meter;
+ModeGovernor governor;
 
+const int NUM_VOICES = 4;
 const int NUM_MODES = 60;
-const float NOTE_OFF_DECAY = 0.01;
+const int BLOCK_SIZE = 4;  // number of samples handled per callback
+// The governor keeps the average callback load below TARGET_LOAD by
+// rendering fewer modes, but never fewer than MIN_MODES.
+const float TARGET_LOAD = 0.8f;
+const int MIN_MODES = 12;
 
-volatile float _knob = 0.0f;
-float amplitude = 0.0f;
-float decay = 0.0f;
-float decay_high_freq = 0.0f;
-int current_note = 0;
+// All of the synth's oscillator state, carved out by an arena pool in
+// Init() and never freed.  It fits in DTCM, the fastest RAM on the Daisy.
+// An arena aligns its blocks relative to its start, so the buffers of the
+// pools are aligned here: for the vector loads of the banks, and for the
+// pool's own block alignment.
+DTCM_MEM_SECTION alignas(SIMD_ALIGN) char synth_memory[
+    StringSynth::StorageBytes(NUM_VOICES, NUM_MODES)];
 
-inline float midi_to_freq(float m) {
-  // Convert a MIDI note to frequency in Hz
-  return powf(2, (m - 69.0f) / 12.0f) * 440.0f;
-}
+// The note table and the spectrum cache, which only the main loop reads, in
+// the larger main SRAM
+alignas(MPOOL_ALIGN_SIZE) char note_table_memory[
+    StringSynth::NoteTableBytes(NUM_MODES)];
+tMempool note_table_pool;
+alignas(MPOOL_ALIGN_SIZE) char spectrum_cache_memory[
+    StringSynth::SpectrumCacheBytes(NUM_MODES)];
+tMempool spectrum_cache_pool;
+
+volatile float _knob = 0.0f;
 
 void AudioCallback(daisy::AudioHandle::InputBuffer in,
                    daisy::AudioHandle::OutputBuffer out,
                    size_t size) {
-  for (size_t i = 0; i < size; i++) {
-    float sample = amplitude * string.Tick();
-    out[0][i] = sample;
-    out[1][i] = sample;
-  }
-}
-
-inline float MidiScale(int midi_value, float min, float max) {
-  // Scale a MIDI parameter value (between 0 and 127) to the range [min, max]
-  return min + static_cast<float>(midi_value) / 127.0f * (max - min);
+  load_meter.BlockStart();
+  synth.Process(in[0], out[0], out[1], size);
+  load_meter.BlockEnd();
 }
 
 void HandleMidiMessage(daisy::MidiEvent m) {
   switch (m.type) {
     case daisy::NoteOn: {
       auto p = m.AsNoteOn();
-      current_note = p.note;
-      string.set_freq(midi_to_freq(p.note));
-      string.set_decay(decay);
-      string.SetInitialAmplitudes();
-      amplitude = MidiScale(p.velocity, 0.0f, 1.0f);
+      synth.NoteOn(p.note, p.velocity);
     }
       break;
     case daisy::NoteOff: {
       auto p = m.AsNoteOff();
-      if (p.note == current_note) {
-        string.set_decay(NOTE_OFF_DECAY);
-      }
+      synth.NoteOff(p.note);
     }
       break;
     case daisy::ControlChange: {
       auto p = m.AsControlChange();
-      switch (p.control_number) {
-        case 1:
-          string.set_stiffness(MidiScale(p.value, 0.0f, 0.2f));
-          break;
-        case 2:
-          string.set_pluck_pos(MidiScale(p.value, 0.001f, 1.0f));
-          break;
-        case 3:
-          decay_high_freq = MidiScale(p.value, 0.0f, 0.0005f);
-          string.set_decay_high_freq(decay_high_freq);
-          break;
-        case 4:
-          decay = MidiScale(p.value, 0.0f, 0.005f);
-          string.set_decay(decay);
-          break;
-        default: break;
-      }
+      synth.ControlChange(p.control_number, p.value);
     }
+      break;
     default: break;
   }
 }
 
 int main(void) {
   hw.Init();
-  hw.SetAudioBlockSize(4);  // number of samples handled per callback
+  hw.SetAudioBlockSize(BLOCK_SIZE);
   hw.SetAudioSampleRate(daisy::SaiHandle::Config::SampleRate::SAI_48KHZ);
   hw.StartAdc();
-  string.Init(hw.AudioSampleRate(), NUM_MODES);
+  LEAF *leaf = LEAF_init(hw.AudioSampleRate(), synth_memory,
+                         sizeof(synth_memory), nullptr);
+  mpool_create_arena(synth_memory, sizeof(synth_memory), leaf->mempool);
+  synth.Init(hw.AudioSampleRate(), NUM_VOICES, NUM_MODES, leaf->mempool);
+  note_table_pool.leaf = leaf;
+  mpool_create_arena(note_table_memory, sizeof(note_table_memory),
+                     &note_table_pool);
+  synth.InitNoteTable(&note_table_pool);
+  spectrum_cache_pool.leaf = leaf;
+  mpool_create_arena(spectrum_cache_memory, sizeof(spectrum_cache_memory),
+                     &spectrum_cache_pool);
+  synth.InitSpectrumCache(&spectrum_cache_pool);
+  load_meter.Init(hw.AudioSampleRate(), BLOCK_SIZE);
+  governor.Init(load_meter.blocks_per_second(), MIN_MODES, NUM_MODES,
+                TARGET_LOAD);
   hw.StartAudio(AudioCallback);
   hw.midi.StartReceive();
   while (1) {
@@ -100,5 +102,9 @@ int main(void) {
       HandleMidiMessage(hw.midi.PopEvent());
     }
     _knob = hw.GetKnobValue(hw.KNOB_1);
+    if (governor.Update(load_meter)) {
+      synth.set_max_modes(governor.max_modes());
+    }
+    synth.UpdateNoteTable();
   }
 }
@@ -0,0 +1,169 @@
+/*
+  render.cpp
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+
+  Offline renderer: plays a Standard MIDI File through StringSynth (with
+  the same note and controller mapping as the firmware) and writes a WAV
+  file.  Runs on the host; see Makefile.host.
+
+  Usage: render [options] input.mid output.wav
+    -r rate     sample rate (default 48000)
+    -b size     block size (default 4, as on the Daisy)
+    -v voices   number of voices (default 4)
+    -m modes    number of modes per voice (default 60)
+    -t seconds  longest tail to render after the last event (default 10)
+    -f          write 32-bit float instead of 16-bit PCM
+    -l load     run the mode governor with this target load (see LoadMeter.h)
+
+  The load reported at the end is the host's render time per block, as a
+  fraction of the block's duration.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <chrono>
+#include "LoadMeter.h"
+#include "MidiFile.h"
+#include "StringSynth.h"
+#include "WavWriter.h"
+#include "leaflet.h"
+
+const size_t MAX_BLOCK_SIZE = 4096;
+
+static StringSynth synth;
+
+void Usage() {
+  fprintf(stderr,
+          "usage: render [-r rate] [-b block_size] [-v voices] [-m modes]\n"
+          "              [-t tail_seconds] [-f] [-l target_load]\n"
+          "              input.mid output.wav\n");
+  exit(1);
+}
+
+void Dispatch(const MidiFileEvent &e) {
+  switch (e.type()) {
+    case MIDI_NOTE_ON:
+      synth.NoteOn(e.data1, e.data2);
+      break;
+    case MIDI_NOTE_OFF:
+      synth.NoteOff(e.data1);
+      break;
+    case MIDI_CONTROL_CHANGE:
+      synth.ControlChange(e.data1, e.data2);
+      break;
+    default: break;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  int sample_rate = 48000;
+  size_t block_size = 4;
+  int num_voices = 4;
+  int num_modes = 60;
+  double max_tail = 10.0;
+  WavWriter::Format format = WavWriter::PCM_16;
+  float target_load = 0.0f;  // no governor
+  int opt;
+  while ((opt = getopt(argc, argv, "r:b:v:m:t:fl:")) != -1) {
+    switch (opt) {
+      case 'r': sample_rate = atoi(optarg); break;
+      case 'b': block_size = atoi(optarg); break;
+      case 'v': num_voices = atoi(optarg); break;
+      case 'm': num_modes = atoi(optarg); break;
+      case 't': max_tail = atof(optarg); break;
+      case 'f': format = WavWriter::FLOAT_32; break;
+      case 'l': target_load = atof(optarg); break;
+      default: Usage();
+    }
+  }
+  if (argc - optind != 2 || block_size < 1 || block_size > MAX_BLOCK_SIZE ||
+      num_voices < 1 || num_voices > MAX_NUM_VOICES ||
+      num_modes < 1 || num_modes > MAX_NUM_MODES) {
+    Usage();
+  }
+
+  MidiFile midi;
+  if (!midi.Read(argv[optind])) {
+    fprintf(stderr, "render: cannot read MIDI file %s\n", argv[optind]);
+    return 1;
+  }
+  WavWriter wav;
+  if (!wav.Open(argv[optind + 1], sample_rate, 2, format)) {
+    fprintf(stderr, "render: cannot open %s\n", argv[optind + 1]);
+    return 1;
+  }
+  // The synth's storage comes from an arena, as on the Daisy (where the note
+  // table and the spectrum cache have arenas of their own)
+  size_t memory_size = StringSynth::StorageBytes(num_voices, num_modes) +
+                       StringSynth::NoteTableBytes(num_modes) +
+                       StringSynth::SpectrumCacheBytes(num_modes);
+  char *memory = static_cast<char *>(malloc(memory_size));
+  LEAF *leaf = LEAF_init(sample_rate, memory, memory_size, nullptr);
+  mpool_create_arena(memory, memory_size, leaf->mempool);
+  if (!synth.Init(sample_rate, num_voices, num_modes, leaf->mempool) ||
+      !synth.InitNoteTable(leaf->mempool) ||
+      !synth.InitSpectrumCache(leaf->mempool)) {
+    fprintf(stderr, "render: out of synth memory\n");
+    return 1;
+  }
+  fprintf(stderr, "%d voices x %d modes: %zu bytes\n", num_voices, num_modes,
+          synth.footprint());
+  LoadMeter meter;
+  meter.Init(sample_rate, block_size);
+  ModeGovernor governor;
+  governor.Init(meter.blocks_per_second(), 1, num_modes, target_load);
+  int min_modes = num_modes;
+
+  static float left[MAX_BLOCK_SIZE];
+  static float right[MAX_BLOCK_SIZE];
+  const float *channels[] = {left, right};
+  const std::vector<MidiFileEvent> &events = midi.events();
+  size_t next = 0;
+  double end_time = midi.duration();
+  long frame = 0;
+  auto start = std::chrono::steady_clock::now();
+  while (true) {
+    double time = static_cast<double>(frame) / sample_rate;
+    // events are applied at block boundaries, as on the Daisy
+    while (next < events.size() && events[next].time <= time) {
+      Dispatch(events[next++]);
+    }
+    if (next == events.size() &&
+        (time >= end_time + max_tail || synth.voices().num_active() == 0)) {
+      break;
+    }
+    meter.BlockStart();
+    synth.Process(left, right, block_size);
+    meter.BlockEnd();
+    if (target_load > 0.0f && governor.Update(meter)) {
+      synth.set_max_modes(governor.max_modes());
+      if (governor.max_modes() < min_modes) {
+        min_modes = governor.max_modes();
+      }
+    }
+    wav.Write(channels, block_size);
+    frame += block_size;
+    // the Daisy's main loop does this between MIDI messages
+    synth.UpdateNoteTable();
+  }
+  auto end = std::chrono::steady_clock::now();
+  if (!wav.Close()) {
+    fprintf(stderr, "render: error writing %s\n", argv[optind + 1]);
+    return 1;
+  }
+  std::chrono::duration<double> elapsed = end - start;
+  double audio_seconds = static_cast<double>(frame) / sample_rate;
+  fprintf(stderr, "%zu events, %.2f s of audio in %.3f s (%.1fx real time)\n",
+          events.size(), audio_seconds, elapsed.count(),
+          audio_seconds / elapsed.count());
+  fprintf(stderr, "load: mean %.2f%%, peak %.2f%%, %u overruns\n",
+          100 * meter.mean_load(), 100 * meter.peak_load(),
+          meter.num_overruns());
+  if (target_load > 0.0f) {
+    fprintf(stderr, "governor: down to %d modes\n", min_modes);
+  }
+  return 0;
+}
@@ -0,0 +1,112 @@
+/*
+  teststringbank.cpp
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+
+  Test that the output of a StringBank does not depend on the block size:
+  the same strings, coupled and plucked in the same way, rendered in
+  blocks of 4 and of 64 samples (and of 100, longer than the bridge delay,
+  with two pickups), must give the same samples exactly.  With the bridge
+  signal delayed by the length of a block, the coupling would change with
+  the block size.
+
+  Exits with status 1 if any output differs.
+
+  Usage: teststringbank
+*/
+
+#include <stdio.h>
+#include <memory>
+#include <vector>
+#include "StringBank.h"
+#include "leaflet.h"
+
+namespace {
+
+const float kSampleRate = 48000.0f;
+const int kNumStrings = 6;
+const int kNumModes = 40;
+const int kNumPickups = 2;
+const size_t kMaxBlockSize = 100;
+
+// Pluck three of the six strings of a freshly initialized bank, with
+// strong coupling, and render num_samples samples of each pickup in blocks
+// of block_size
+std::vector<float> Render(StringBank *bank, size_t block_size,
+                          size_t num_samples) {
+  const float freqs[kNumStrings] = {82.4f, 110.0f, 146.8f,
+                                    196.0f, 246.9f, 329.6f};
+  bank->set_coupling(0.8f);
+  for (int s = 0; s < kNumStrings; ++s) {
+    BankString &string = bank->string(s);
+    string.set_decay(0.001f);
+    string.set_pickup_pos(0, 0.3f);
+    string.set_pickup_pos(1, 0.11f);
+    string.set_freq(freqs[s]);
+    if (s % 2 == 0) {
+      string.SetInitialAmplitudes();
+    } else {
+      string.SetAmplitudes();
+    }
+  }
+  std::vector<float> out(kNumPickups * num_samples);
+  float buf[kNumPickups][kMaxBlockSize];
+  float *bufs[kNumPickups] = {buf[0], buf[1]};
+  for (size_t j = 0; j < num_samples; j += block_size) {
+    size_t n = num_samples - j < block_size ? num_samples - j : block_size;
+    bank->Process(bufs, n);
+    for (int k = 0; k < kNumPickups; ++k) {
+      for (size_t i = 0; i < n; ++i) {
+        out[k * num_samples + j + i] = buf[k][i];
+      }
+    }
+  }
+  return out;
+}
+
+}  // namespace
+
+int main() {
+  const size_t memory_size =
+      StringBank::StorageBytes(kNumStrings, kNumModes, kNumPickups);
+  static std::vector<char> memory(memory_size);
+  LEAF *leaf = LEAF_init(kSampleRate, memory.data(), memory_size, nullptr);
+  const size_t num_samples = static_cast<size_t>(0.5f * kSampleRate);
+  const size_t block_sizes[] = {4, 64, kMaxBlockSize};
+  std::vector<float> ref;
+  int num_failures = 0;
+  for (size_t block_size : block_sizes) {
+    // a new bank each time, which frees its storage before the pool is
+    // reset for the next
+    mpool_create_arena(memory.data(), memory_size, leaf->mempool);
+    std::unique_ptr<StringBank> bank(new StringBank);
+    if (!bank->Init(kSampleRate, kNumStrings, kNumModes, leaf->mempool,
+                    kNumPickups)) {
+      printf("out of memory\n");
+      return 1;
+    }
+    std::vector<float> out = Render(bank.get(), block_size, num_samples);
+    if (ref.empty()) {
+      ref = out;
+    }
+    size_t num_diffs = 0;
+    float peak = 0.0f;
+    for (size_t j = 0; j < out.size(); ++j) {
+      num_diffs += out[j] != ref[j];
+      peak = out[j] > peak ? out[j] : -out[j] > peak ? -out[j] : peak;
+    }
+    bool ok = num_diffs == 0 && peak > 0.0f;
+    printf("block %3zu  peak %.4f  %zu samples differ  %s\n", block_size,
+           peak, num_diffs, ok ? "ok" : "FAIL");
+    if (!ok) {
+      ++num_failures;
+    }
+  }
+  if (num_failures > 0) {
+    printf("%d failures\n", num_failures);
+    return 1;
+  }
+  printf("all ok\n");
+  return 0;
+}
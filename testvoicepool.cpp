@@ -0,0 +1,107 @@
+/*
+  testvoicepool.cpp
+  Clancy Rowley
+
+  Copyright 2023 Clarence W. Rowley
+
+  Test that VoicePool does not cut off the tail of a released note.  A low
+  note, rendered in blocks of 4 samples as on the Daisy, is released and
+  left to die away, and compared with the same note in a pool that never
+  frees its voices.  Once freed, the voice must have been quiet: the
+  difference, which is the part of the tail that was cut off, must stay
+  below twice the silence threshold.  With the peak of a single block
+  deciding, the note was cut off where it passed through zero, well above
+  the threshold.
+
+  Exits with status 1 if a tail is cut off, or a voice is never freed.
+
+  Usage: testvoicepool
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <memory>
+#include <vector>
+#include "VoicePool.h"
+#include "leaflet.h"
+
+namespace {
+
+const float kSampleRate = 48000.0f;
+const size_t kBlockSize = 4;
+const int kNumModes = 60;
+const float kThreshold = 1.0e-4f;
+
+// Play freq_hz for held seconds, release it, and render seconds more.
+// Returns the samples after the release, and sets *freed_at to the sample
+// (after the release) at which the voice was freed, or -1.
+std::vector<float> Render(VoicePool *pool, float freq_hz, float held,
+                          float seconds, long *freed_at) {
+  pool->NoteOn(0, 1.0f, [=](StiffString &s) {
+    s.set_decay(0.02f);
+    s.set_decay_high_freq(0.002f);
+    s.set_freq(freq_hz);
+    s.SetInitialAmplitudes();
+  });
+  float block[kBlockSize];
+  for (long j = 0; j < static_cast<long>(held * kSampleRate);
+       j += kBlockSize) {
+    pool->Process(block, kBlockSize);
+  }
+  pool->NoteOff(0);
+  std::vector<float> out(static_cast<size_t>(seconds * kSampleRate));
+  *freed_at = -1;
+  for (size_t j = 0; j < out.size(); j += kBlockSize) {
+    pool->Process(&out[j], kBlockSize);
+    if (*freed_at < 0 && pool->num_active() == 0) {
+      *freed_at = j;
+    }
+  }
+  return out;
+}
+
+}  // namespace
+
+int main() {
+  const size_t memory_size = VoicePool::StorageBytes(1, kNumModes);
+  static std::vector<char> memory(memory_size);
+  LEAF *leaf = LEAF_init(kSampleRate, memory.data(), memory_size, nullptr);
+  const float freqs[] = {27.5f, 41.2f, 55.0f};
+  const float seconds = 8.0f;
+  int num_failures = 0;
+  for (float freq : freqs) {
+    // a new pool each time, as in teststringbank.cpp
+    mpool_create_arena(memory.data(), memory_size, leaf->mempool);
+    std::unique_ptr<VoicePool> ref_pool(
+        new VoicePool(kSampleRate, 1, kNumModes, leaf->mempool));
+    ref_pool->set_silence_threshold(0.0f);  // never frees the voice
+    long ref_freed_at;
+    std::vector<float> ref = Render(ref_pool.get(), freq, 0.5f, seconds,
+                                    &ref_freed_at);
+    ref_pool.reset();
+
+    mpool_create_arena(memory.data(), memory_size, leaf->mempool);
+    std::unique_ptr<VoicePool> pool(
+        new VoicePool(kSampleRate, 1, kNumModes, leaf->mempool));
+    pool->set_silence_threshold(kThreshold);
+    long freed_at;
+    std::vector<float> out = Render(pool.get(), freq, 0.5f, seconds,
+                                    &freed_at);
+    float cut = 0.0f;
+    for (size_t j = 0; j < out.size(); ++j) {
+      cut = fmaxf(cut, fabsf(out[j] - ref[j]));
+    }
+    bool ok = freed_at >= 0 && cut <= 2.0f * kThreshold;
+    printf("freq %5.1f  freed after %.3f s  cut off %.2e  %s\n", freq,
+           freed_at / kSampleRate, cut, ok ? "ok" : "FAIL");
+    if (!ok) {
+      ++num_failures;
+    }
+  }
+  if (num_failures > 0) {
+    printf("%d failures\n", num_failures);
+    return 1;
+  }
+  printf("all ok\n");
+  return 0;
+}